@@ -0,0 +1,71 @@
+#define _DEFAULT_SOURCE
+#include "arena.h"
+#include <sys/mman.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define HUGE_PAGE_SIZE (2u << 20)
+
+static void* map_pages(size_t capacity, unsigned flags)
+{
+    void* p;
+    if (flags & ARENA_HUGE_PAGES) {
+        // Explicit huge pages need a reserved pool, fall back to transparent ones
+        p = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) return p;
+    }
+
+    p = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (p == MAP_FAILED) return NULL;
+
+    if (flags & ARENA_HUGE_PAGES) madvise(p, capacity, MADV_HUGEPAGE);
+    return p;
+}
+
+arena_s* arena_create(size_t capacity, unsigned flags)
+{
+    if (flags & ARENA_HUGE_PAGES) {
+        capacity = (capacity + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    uint8_t* base = map_pages(capacity, flags);
+    if (!base) return NULL;
+
+    arena_s* a = calloc(1, sizeof(arena_s));
+    *a = (arena_s){.base = base, .capacity = capacity, .used = 0, .dirty = 0};
+    return a;
+}
+
+void arena_destroy(arena_s* a)
+{
+    if (!a) return;
+
+    munmap(a->base, a->capacity);
+    free(a);
+}
+
+void* arena_alloc(arena_s* a, size_t size)
+{
+    size_t begin = (a->used + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (begin > a->capacity || size > a->capacity - begin) return NULL;
+
+    uint8_t* p = a->base + begin;
+    a->used = begin + size;
+
+    // Fresh pages are zero already, only memory handed out before a reset needs clearing
+    if (begin < a->dirty) memset(p, 0, MIN(a->dirty, a->used) - begin);
+    a->dirty = MAX(a->dirty, a->used);
+    return p;
+}
+
+void* arena_calloc(arena_s* a, size_t count, size_t size)
+{
+    assert(size == 0 || count <= SIZE_MAX / size);
+    return arena_alloc(a, count * size);
+}
+
+void arena_reset(arena_s* a)
+{
+    a->used = 0;
+}
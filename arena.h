@@ -0,0 +1,24 @@
+#ifndef INCLUDED_ARENA_H_
+#define INCLUDED_ARENA_H_
+
+#include "constants.h"
+
+#define ARENA_HUGE_PAGES 0x1u
+#define ARENA_ALIGNMENT 64
+
+// Bump allocator over a single reserved mapping. Allocations are zeroed and
+// cache line aligned; they are only released all at once by reset or destroy.
+typedef struct
+{
+    uint8_t* base;
+    size_t capacity;
+    size_t used;
+    size_t dirty;
+} arena_s;
+
+arena_s* arena_create(size_t capacity, unsigned flags);
+void arena_destroy(arena_s* a);
+void* arena_alloc(arena_s* a, size_t size);
+void* arena_calloc(arena_s* a, size_t count, size_t size);
+void arena_reset(arena_s* a);
+#endif
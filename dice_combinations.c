@@ -33,17 +33,28 @@ static size_t total_state_count(size_t dice_count, size_t face_count)
     return numerator / denominator;
 }
 
+// n! for small n; exact in a double, so the same values tgamma(n + 1) gives
+static double factorial(unsigned n)
+{
+    static const double s_factorials[] = {
+        1.0, 1.0, 2.0, 6.0, 24.0, 120.0, 720.0, 5040.0, 40320.0, 362880.0, 3628800.0,
+    };
+
+    if (n < sizeof(s_factorials) / sizeof(s_factorials[0])) return s_factorials[n];
+    return tgamma(n + 1);
+}
+
 static double calc_state_probability(const dice_state_s* d)
 {
     unsigned dice_count = 0;
     double denominator = 1;
     for (size_t idx = 0; idx < TOTAL_DICE_FACES; ++idx) {
         dice_count += d->face_counts[idx];
-        denominator *= tgamma(d->face_counts[idx] + 1);
+        denominator *= factorial(d->face_counts[idx]);
     }
 
     const double p = 1.0 / TOTAL_DICE_FACES;
-    double numerator = tgamma(dice_count + 1) * pow(p, dice_count);
+    double numerator = factorial(dice_count) * pow(p, dice_count);
     return numerator / denominator;
 }
 
@@ -88,16 +99,65 @@ const dice_state_s* dice_state_iterator_get(const dice_state_iterator_s* it)
     return &it->elem;
 }
 
-dice_state_cache_s* dice_state_cache_create(size_t dice_count)
+size_t dice_state_count(size_t dice_count)
 {
-    dice_state_cache_s* c = calloc(1, sizeof(dice_state_cache_s));
+    return total_state_count(dice_count, TOTAL_DICE_FACES);
+}
+
+// States are enumerated in lexicographic order of the first TOTAL_DICE_FACES - 1
+// face counts; the last face takes the remaining dice. The number of states
+// sharing a prefix is the number of ways to distribute the remaining dice.
+size_t dice_state_index(const dice_state_s* d)
+{
+    size_t index = 0;
+    size_t remaining = 0;
+    for (size_t face = 0; face < TOTAL_DICE_FACES; ++face) {
+        remaining += d->face_counts[face];
+    }
+
+    for (size_t face = 0; face < TOTAL_DICE_FACES - 1; ++face) {
+        for (size_t v = 0; v < d->face_counts[face]; ++v) {
+            index += total_state_count(remaining - v, TOTAL_DICE_FACES - face - 1);
+        }
+        remaining -= d->face_counts[face];
+    }
 
-    c->count = total_state_count(dice_count, TOTAL_DICE_FACES);
-    c->states = calloc(c->count, sizeof(dice_state_s));
+    return index;
+}
+
+void dice_state_from_index(dice_state_s* d, size_t dice_count, size_t index)
+{
+    assert(index < dice_state_count(dice_count));
+
+    size_t remaining = dice_count;
+    for (size_t face = 0; face < TOTAL_DICE_FACES - 1; ++face) {
+        size_t v = 0;
+        size_t block;
+        while (index >= (block = total_state_count(remaining - v, TOTAL_DICE_FACES - face - 1))) {
+            index -= block;
+            ++v;
+        }
+        d->face_counts[face] = v;
+        remaining -= v;
+    }
+
+    d->face_counts[TOTAL_DICE_FACES - 1] = remaining;
+    d->prob = calc_state_probability(d);
+}
+
+void dice_state_cache_init(dice_state_cache_s* c, size_t dice_count, dice_state_s* states)
+{
+    c->count = dice_state_count(dice_count);
+    c->states = states;
 
     size_t act_len = generate_dice_states(dice_count, c->states);
     assert(act_len == c->count);
+}
 
+dice_state_cache_s* dice_state_cache_create(size_t dice_count)
+{
+    dice_state_cache_s* c = calloc(1, sizeof(dice_state_cache_s));
+    dice_state_cache_init(c, dice_count, calloc(dice_state_count(dice_count), sizeof(dice_state_s)));
     return c;
 }
 
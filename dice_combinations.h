@@ -29,6 +29,11 @@ void dice_state_iterator_incr(dice_state_iterator_s* it);
 
 const dice_state_s* dice_state_iterator_get(const dice_state_iterator_s* it);
 
+size_t dice_state_count(size_t dice_count);
+size_t dice_state_index(const dice_state_s* d);
+void dice_state_from_index(dice_state_s* d, size_t dice_count, size_t index);
+
+void dice_state_cache_init(dice_state_cache_s* c, size_t dice_count, dice_state_s* states);
 dice_state_cache_s* dice_state_cache_create(size_t dice_count);
 void dice_state_cache_destroy(dice_state_cache_s* c);
 #endif
\ No newline at end of file
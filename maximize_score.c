@@ -1,299 +1,578 @@
 #include "pickomino.h"
 #include "dice_combinations.h"
 #include "random.h"
+#include "pickomino_log.h"
+#include "solver.h"
+#include "pickomino_tablebase.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 #include <assert.h>
+#include <threads.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define MIN_STOP_SCORE SOLVER_MIN_STOP_SCORE
+
+#define VERIFY_DEFAULT_SAMPLES 2000
+#define VERIFY_DEFAULT_THREADS 4
+#define VERIFY_MAX_THREADS 64
+#define VERIFY_DELTA 1e-9
+#define VERIFY_REPORT_COUNT 10
+// States with at most this many faces used start long turns where errors build
+// up, they get more samples
+#define VERIFY_NEAR_START_FACES 1
+#define VERIFY_NEAR_START_FACTOR 16
+// Two sided normal quantile for VERIFY_DELTA
+#define VERIFY_CENTER_BOUND 6.11
+
+#define TABLEBASE_DEFAULT_TILES 2
+
+static const char* format_state(const solver_s* solver, const pickomino_roll_state_s* state)
+{
+    static char tpl[32];
+    roll_stats_s* stats = solver_find_roll_stats(solver, state);
+    snprintf(tpl, sizeof(tpl),
+             "(%d, %d, %.1f, %.2f %d%d%d%d%d%d)",
+             state->score,
+             state->dices_remaining,
+             stats->value,
+             stats->p_bust,
+             (bool)(state->used_flags & 1),
+             (bool)(state->used_flags & 2),
+             (bool)(state->used_flags & 4),
+             (bool)(state->used_flags & 8),
+             (bool)(state->used_flags & 16),
+             (bool)(state->used_flags & 32));
+    return tpl;
+}
 
-#define TOTAL_USED_STATES 64
-#define REQUIRED_FACE (TOTAL_DICE_FACES - 1)
-#define MIN_STOP_SCORE 21
-
-typedef struct
+static const char* format_roll(const dice_state_s* d)
 {
-    double value;
-    double p_score[PICKOMINO_ROLL_REWARD_DIM];
-    double p_bust;
-} roll_stats_s;
+    static char tpl[32];
+    pickomino_roll_format(d, tpl, sizeof(tpl));
+    return tpl;
+}
 
-typedef struct
+void do_random_roll(dice_state_s* result, size_t dices)
 {
-    roll_stats_s *values;
-    unsigned min_score;
-    unsigned score_dim;
-} roll_stats_dice_dim_s;
+    assert(dices <= PICKOMINO_TOTAL_DICES);
 
-typedef struct
+    dice_state_s tmp = {.face_counts = {}};
+    uint8_t rolls[PICKOMINO_TOTAL_DICES] = {};
+    random_uniform(TOTAL_DICE_FACES, rolls, dices);
+    for (size_t idx = 0; idx < dices; ++idx) {
+        ++(tmp.face_counts[rolls[idx]]);
+    }
+    *result = tmp;
+}
+
+static bool find_best_action(const solver_s* solver, const pickomino_roll_state_s* game, const dice_state_s* dice, pickomino_roll_state_s* best, unsigned* best_action)
 {
-    roll_stats_dice_dim_s* values;
-    size_t min_dice_remaining;
-    size_t dice_dim;
-    size_t total_stats_count;
-} roll_stats_flags_dim_s;
+    bool have_action = false;
+    double max_state_action_value = 0;
+    pickomino_roll_state_s tmp;
 
-static dice_state_cache_s* s_dice_states[PICKOMINO_TOTAL_DICES];
-static roll_stats_flags_dim_s s_roll_stats[TOTAL_USED_STATES];
-size_t g_total_roll_stats_count;
+    unsigned available_actions = pickomino_roll_available_actions(game, dice);
+    for (unsigned action = 0; available_actions; available_actions >>= 1, ++action) {
+        if ((available_actions & 0x1) == 0) continue;
 
-static unsigned pop_count(unsigned v)
+        tmp = *game;
+        pickomino_roll_action(&tmp, dice, action);
+        double value = solver_find_roll_stats(solver, &tmp)->value;
+
+        if (!have_action || value > max_state_action_value) {
+            *best = tmp;
+            *best_action = action;
+            max_state_action_value = value;
+            have_action = true;
+        }
+    }
+
+    return have_action;
+}
+
+static void play_game(const solver_s* solver)
 {
-    unsigned c = 0;
-    do { c += (v & 1); } while (v >>= 1);
-    return c;
+    pickomino_roll_state_s game = {0, PICKOMINO_TOTAL_DICES, 0, {}};
+
+    random_init();
+    while (true)
+    {
+        printf("state: %s\n", format_state(solver, &game));
+
+
+        if (solver_find_roll_stats(solver, &game)->value == game.score) {
+            printf("stop\n");
+            break;
+        }
+
+        dice_state_s dice;
+        do_random_roll(&dice, game.dices_remaining);
+        printf("roll: %s\n", format_roll(&dice));
+
+        unsigned available_actions = pickomino_roll_available_actions(&game, &dice);
+        for (unsigned action = 0; available_actions; available_actions >>= 1, ++action) {
+            if ((available_actions & 0x1) == 0) continue;
+
+            pickomino_roll_state_s tmp = game;
+            pickomino_roll_action(&tmp, &dice, action);
+            printf("action: %c -> %s\n", g_pickomino_face_symbols[action], format_state(solver, &tmp));
+        }
+
+        pickomino_roll_state_s next;
+        unsigned action = 0;
+        if (!find_best_action(solver, &game, &dice, &next, &action)) {
+            printf("bust!\n");
+            break;
+        }
+
+        game = next;
+        printf("do: %c\n\n", g_pickomino_face_symbols[action]);
+    }
 }
 
-static void roll_stats_dice_dim_init(roll_stats_dice_dim_s* l, size_t min_score, size_t max_score)
+// Plays a turn from the given state under the solved policy; logs it if log is not NULL.
+static unsigned play_turn(const solver_s* solver, pickomino_roll_state_s game, pickomino_log_writer_s* log)
 {
-    l->min_score = min_score;
-    l->score_dim = (max_score - min_score) + 1;
-    l->values = calloc(l->score_dim, sizeof(roll_stats_s));
+    while (solver_find_roll_stats(solver, &game)->value != game.score) {
+        dice_state_s dice;
+        pickomino_roll_state_s next;
+        unsigned action = 0;
+        do_random_roll(&dice, game.dices_remaining);
+        if (log) pickomino_log_roll(log, &dice);
+
+        if (!find_best_action(solver, &game, &dice, &next, &action)) {
+            if (log) pickomino_log_bust(log);
+            return PICKOMINO_ROLL_BUSTED;
+        }
+
+        if (log) pickomino_log_action(log, action);
+        game = next;
+    }
+
+    if (log) pickomino_log_stop(log);
+    return pickomino_roll_finalize(&game);
 }
 
-static void roll_stats_flags_dim_init(roll_stats_flags_dim_s* r, unsigned used_flags)
+static int simulate_games(const solver_s* solver, const char* path, size_t game_count, unsigned player_count)
 {
-    size_t min_dice_idx = SIZE_MAX;
-    size_t max_dice_idx = SIZE_MAX;
-    size_t min_score = 0;
-    size_t min_dice_used = 0;
-
-    for (size_t idx = 0; idx < TOTAL_DICE_FACES; ++idx) {
-        if (((1u << idx) & used_flags) == 0) continue;
-        if (min_dice_idx != SIZE_MAX) min_dice_idx = idx;
-
-        ++min_dice_used;
-        max_dice_idx = idx;
-        min_score += g_pickomino_face_scores[idx];
+    pickomino_log_writer_s* log = pickomino_log_writer_create(path);
+    if (!log) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
     }
 
-    size_t max_dice_used = used_flags == 0 ? 0 : PICKOMINO_TOTAL_DICES;
-    size_t dice_dim = (max_dice_used - min_dice_used) + 1;
+    random_init();
+    for (size_t game_id = 0; game_id < game_count; ++game_id) {
+        pickomino_game_state_s game;
+        pickomino_game_init(&game, player_count);
+        pickomino_log_game_begin(log, player_count);
+
+        while (!pickomino_game_is_done(&game)) {
+            pickomino_roll_state_s start;
+            pickomino_roll_init(&start);
+            unsigned roll_score = play_turn(solver, start, log);
+            pickomino_tile_transfer_s transfer = pickomino_game_process_roll(&game, roll_score);
+            pickomino_log_transfer(log, &transfer);
+            pickomino_game_next_player(&game);
+        }
 
-    r->values = calloc(dice_dim, sizeof(roll_stats_dice_dim_s));
-    r->dice_dim = dice_dim;
-    r->min_dice_remaining = PICKOMINO_TOTAL_DICES - max_dice_used;
+        pickomino_log_game_end(log);
+    }
 
-    size_t min_score_per_dice = min_dice_idx == SIZE_MAX ? 0 : g_pickomino_face_scores[min_dice_idx];
-    size_t max_score_per_dice = max_dice_idx == SIZE_MAX ? 0 : g_pickomino_face_scores[max_dice_idx];
-    for (size_t idx = 0; idx < dice_dim; ++idx) {
-        size_t list_min_score = min_score + min_score_per_dice * (dice_dim - idx - 1);
-        size_t list_max_score = min_score + max_score_per_dice * (dice_dim - idx - 1);
-        roll_stats_dice_dim_init(&r->values[idx], list_min_score, list_max_score);
-        r->total_stats_count += r->values[idx].score_dim;
+    if (!pickomino_log_writer_destroy(log)) {
+        fprintf(stderr, "Could not write %s\n", path);
+        return 1;
     }
+    return 0;
 }
 
-static void setup()
+static int dump_log(const char* path)
 {
-    for (size_t dice_id = 0; dice_id < PICKOMINO_TOTAL_DICES; ++dice_id) {
-        s_dice_states[dice_id] = dice_state_cache_create(dice_id + 1);
+    pickomino_log_reader_s* log = pickomino_log_reader_create(path);
+    if (!log) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return 1;
     }
 
-    g_total_roll_stats_count = 0;
-    for (unsigned flags = 0; flags < TOTAL_USED_STATES; ++flags) {
-        roll_stats_flags_dim_init(&s_roll_stats[flags], flags);
-        g_total_roll_stats_count += s_roll_stats[flags].total_stats_count;
-    }
+    bool ok = pickomino_log_replay(log, stdout);
+    pickomino_log_reader_destroy(log);
+    if (!ok) fprintf(stderr, "Corrupt or inconsistent log %s\n", path);
+    return ok ? 0 : 1;
 }
 
-static roll_stats_s* find_roll_stats(const pickomino_roll_state_s* s)
+typedef struct
 {
-    assert(s->used_flags < TOTAL_USED_STATES);
-    const roll_stats_flags_dim_s* l1 = &s_roll_stats[s->used_flags];
+    pickomino_roll_state_s state;
+    double mean_score;
+    double bust_rate;
+    double score_bound;
+    double bust_bound;
+    double score_z;             // Signed deviations in standard errors, 0 if
+    double bust_z;              // the outcome never varied
+    double ratio;
+} verify_result_s;
 
-    assert(s->dices_remaining - l1->min_dice_remaining < l1->dice_dim);
-    const roll_stats_dice_dim_s* l2 = &l1->values[s->dices_remaining - l1->min_dice_remaining];
-
-    assert(s->score - l2->min_score < l2->score_dim);
-    return &l2->values[s->score - l2->min_score];
+typedef struct
+{
+    const solver_s* solver;
+    verify_result_s* results;
+    size_t count;
+    size_t samples;
+    atomic_size_t next;
+} verify_job_s;
+
+// Empirical Bernstein bound (Maurer & Pontil) on |mean - expectation| that holds
+// with probability 1 - VERIFY_DELTA for samples in a range of width range.
+static double verify_bound(double var, double range, size_t samples)
+{
+    double l = log(2 / VERIFY_DELTA);
+    return sqrt(2 * var * l / samples) + 7 * range * l / (3 * (samples - 1));
 }
 
-roll_stats_dice_dim_s* find_roll_stats_dice_dim(unsigned used_flags, unsigned dices_remaining)
+static double verify_z(double mean, double expected, double var, size_t samples)
 {
-    assert(used_flags < TOTAL_USED_STATES);
-    const roll_stats_flags_dim_s* l1 = &s_roll_stats[used_flags];
-
-    assert(dices_remaining - l1->min_dice_remaining < l1->dice_dim);
-    return &l1->values[dices_remaining - l1->min_dice_remaining];
+    return var > 0 ? (mean - expected) / sqrt(var / samples) : 0;
 }
 
-static const char* format_state(const pickomino_roll_state_s* state)
+static unsigned pop_count(unsigned v)
 {
-    static char tpl[32];
-    roll_stats_s* stats = find_roll_stats(state);
-    snprintf(tpl, sizeof(tpl),
-             "(%d, %d, %.1f, %.2f %d%d%d%d%d%d)",
-             state->score,
-             state->dices_remaining,
-             stats->value,
-             stats->p_bust,
-             (bool)(state->used_flags & 1),
-             (bool)(state->used_flags & 2),
-             (bool)(state->used_flags & 4),
-             (bool)(state->used_flags & 8),
-             (bool)(state->used_flags & 16),
-             (bool)(state->used_flags & 32));
-    return tpl;
+    unsigned c = 0;
+    for (; v; v >>= 1) c += v & 1;
+    return c;
 }
 
-static void update(const pickomino_roll_state_s* src_game)
+static void verify_state(const solver_s* solver, verify_result_s* r, size_t samples)
 {
-    bool has_required_face = src_game->used_flags & (1u << REQUIRED_FACE);
-    bool is_allowed_to_stop = has_required_face && src_game->score >= MIN_STOP_SCORE;
-    double state_stop_value = is_allowed_to_stop ? src_game->score : 0;
-    double state_stop_p_bust = is_allowed_to_stop ? 0 : 1;
-
-    double state_roll_value = 0;
-    double state_roll_p_bust = 1.0;
-
-    if (src_game->dices_remaining > 0 && src_game->used_flags != TOTAL_USED_STATES - 1) {
-        const dice_state_cache_s* dice_cache = s_dice_states[src_game->dices_remaining - 1];
-        state_roll_p_bust = 0;
-
-        for (size_t dice_idx = 0; dice_idx < dice_cache->count; ++dice_idx) {
-            const dice_state_s* dice = &dice_cache->states[dice_idx];
-
-            bool have_action = false;
-            double max_state_action_value = 0;
-            double max_state_action_p_bust = 1.0;
-            for (size_t action = 0; action < TOTAL_DICE_FACES; ++action) {
-                if (src_game->used_flags & (1u << action)) continue;
-                if (dice->face_counts[action] == 0) continue;
-
-                pickomino_roll_state_s dst_game = *src_game;
-                pickomino_roll_action(&dst_game, dice, action);
-                roll_stats_s* dst_stats = find_roll_stats(&dst_game);
-
-                if (!have_action || dst_stats->value > max_state_action_value) {
-                    max_state_action_value = dst_stats->value;
-                    max_state_action_p_bust = dst_stats->p_bust;
-                    have_action = true;
-                }
-            }
+    if (pop_count(r->state.used_flags) <= VERIFY_NEAR_START_FACES) samples *= VERIFY_NEAR_START_FACTOR;
 
-            state_roll_value += dice->prob * max_state_action_value;
-            state_roll_p_bust += dice->prob * max_state_action_p_bust;
-        }
+    double sum = 0, sum_sq = 0;
+    size_t busts = 0;
+
+    for (size_t idx = 0; idx < samples; ++idx) {
+        unsigned score = play_turn(solver, r->state, NULL);
+        if (score < MIN_STOP_SCORE) score = PICKOMINO_ROLL_BUSTED;
+
+        sum += score;
+        sum_sq += (double)score * score;
+        busts += score == PICKOMINO_ROLL_BUSTED;
     }
 
-    double new_value, new_p_bust;
-    if (state_roll_value > state_stop_value) {
-        new_value = state_roll_value;
-        new_p_bust = state_roll_p_bust;
-    } else {
-        new_value = state_stop_value;
-        new_p_bust = state_stop_p_bust;
+    const roll_stats_s* stats = solver_find_roll_stats(solver, &r->state);
+    double score_var = MAX(sum_sq - sum * sum / samples, 0) / (samples - 1);
+    double bust_var = busts * (1 - (double)busts / samples) / (samples - 1);
+
+    r->mean_score = sum / samples;
+    r->bust_rate = (double)busts / samples;
+    r->score_bound = verify_bound(score_var, PICKOMINO_MAX_SCORE, samples);
+    r->bust_bound = verify_bound(bust_var, 1, samples);
+    r->score_z = verify_z(r->mean_score, stats->value, score_var, samples);
+    r->bust_z = verify_z(r->bust_rate, stats->p_bust, bust_var, samples);
+    r->ratio = MAX(fabs(r->mean_score - stats->value) / r->score_bound,
+                   fabs(r->bust_rate - stats->p_bust) / r->bust_bound);
+}
+
+static int verify_worker(void* arg)
+{
+    verify_job_s* job = arg;
+    random_init();
+
+    size_t idx;
+    while ((idx = atomic_fetch_add(&job->next, 1)) < job->count) {
+        verify_state(job->solver, &job->results[idx], job->samples);
     }
 
-    // const char* state_str = format_state(src_game);
-    // printf("  %s: %f -> %f\n", state_str, *src_game->value, new_value);
-    roll_stats_s* src_stats = find_roll_stats(src_game);
-    src_stats->value = new_value;
-    src_stats->p_bust = new_p_bust;
+    return 0;
 }
 
-static const char* format_roll(const dice_state_s* d)
+static int compare_verify_ratio(const void* a, const void* b)
 {
-    static char tpl[32];
-    pickomino_roll_format(d, tpl, sizeof(tpl));
-    return tpl;
+    double ra = ((const verify_result_s*)a)->ratio;
+    double rb = ((const verify_result_s*)b)->ratio;
+    return (ra < rb) - (ra > rb);
 }
 
-void do_random_roll(dice_state_s* result, size_t dices)
+// Sum of the signed deviations over all states, in standard deviations of that
+// sum. Each state may be within its bound, but if the table is biased the
+// deviations are not centred on zero.
+static double verify_center(const verify_result_s* results, size_t count, bool bust)
 {
-    assert(dices <= PICKOMINO_TOTAL_DICES);
+    double sum = 0;
+    size_t n = 0;
+    for (size_t idx = 0; idx < count; ++idx) {
+        double z = bust ? results[idx].bust_z : results[idx].score_z;
+        if (z == 0) continue;
+        sum += z;
+        ++n;
+    }
+    return n ? sum / sqrt(n) : 0;
+}
 
-    dice_state_s tmp = {.face_counts = {}};
-    uint8_t rolls[PICKOMINO_TOTAL_DICES] = {};
-    random_uniform(TOTAL_DICE_FACES, rolls, dices);
-    for (size_t idx = 0; idx < dices; ++idx) {
-        ++(tmp.face_counts[rolls[idx]]);
+// Simulates the given states under the solved policy and checks mean score and
+// bust rate against the table. Sorts results by worst deviation, returns the
+// number of states outside their confidence bound.
+static size_t verify_policy(const solver_s* solver, verify_result_s* results, size_t count, size_t samples, size_t thread_count)
+{
+    verify_job_s job = {.solver = solver, .results = results, .count = count, .samples = samples};
+    atomic_init(&job.next, 0);
+
+    thrd_t threads[VERIFY_MAX_THREADS];
+    thread_count = MIN(MAX(thread_count, 1), VERIFY_MAX_THREADS);
+    for (size_t idx = 0; idx < thread_count; ++idx) {
+        int rc = thrd_create(&threads[idx], verify_worker, &job);
+        assert(rc == thrd_success);
+        (void)rc;
     }
-    *result = tmp;
+    for (size_t idx = 0; idx < thread_count; ++idx) {
+        thrd_join(threads[idx], NULL);
+    }
+
+    qsort(results, count, sizeof(verify_result_s), compare_verify_ratio);
+
+    size_t failures = 0;
+    for (size_t idx = 0; idx < count; ++idx) {
+        failures += results[idx].ratio > 1;
+    }
+    return failures;
 }
 
-static void play_game()
+static int verify_states(const solver_s* solver, verify_result_s* results, size_t count, size_t samples, size_t thread_count)
 {
-    pickomino_roll_state_s game = {0, PICKOMINO_TOTAL_DICES, 0, {}};
-    pickomino_roll_state_s max_action;
-    pickomino_roll_state_s tmp;
-    size_t max_action_idx = 0;
+    size_t failures = verify_policy(solver, results, count, samples, thread_count);
+    double score_center = verify_center(results, count, false);
+    double bust_center = verify_center(results, count, true);
+    bool centered = fabs(score_center) <= VERIFY_CENTER_BOUND && fabs(bust_center) <= VERIFY_CENTER_BOUND;
+
+    printf("Verified %u states, %u samples each (x%u near the turn start), %u outside bounds\n",
+           (unsigned)count, (unsigned)samples, VERIFY_NEAR_START_FACTOR, (unsigned)failures);
+    printf("Deviation sums: score %.2f, bust %.2f (bound %.2f)%s\n",
+           score_center, bust_center, VERIFY_CENTER_BOUND, centered ? "" : ", table is biased");
+    for (size_t idx = 0; idx < MIN(count, VERIFY_REPORT_COUNT); ++idx) {
+        const verify_result_s* r = &results[idx];
+        const roll_stats_s* stats = solver_find_roll_stats(solver, &r->state);
+        printf("  %s: score %.3f vs %.3f +/- %.3f, bust %.4f vs %.4f +/- %.4f (%.2f)\n",
+               format_state(solver, &r->state),
+               r->mean_score, stats->value, r->score_bound,
+               r->bust_rate, stats->p_bust, r->bust_bound,
+               r->ratio);
+    }
 
-    while (true)
-    {
-        printf("state: %s\n", format_state(&game));
+    return failures || !centered ? 1 : 0;
+}
+
+static int verify_all_states(const solver_s* solver, size_t samples, size_t thread_count)
+{
+    verify_result_s* results = calloc(solver->total_roll_stats_count, sizeof(verify_result_s));
+    size_t count = 0;
+
+    for (unsigned flags = 0; flags < SOLVER_USED_STATES; ++flags) {
+        const roll_stats_flags_dim_s* r = &solver->roll_stats[flags];
+        for (size_t dice_id = 0; dice_id < r->dice_dim; ++dice_id) {
+            const roll_stats_dice_dim_s* l = &r->values[dice_id];
+            for (size_t score_id = 0; score_id < l->score_dim; ++score_id) {
+                results[count++].state = (pickomino_roll_state_s){
+                    .dices_remaining = r->min_dice_remaining + dice_id,
+                    .score = l->min_score + score_id,
+                    .used_flags = flags,
+                    .roll_hist = {},
+                };
+            }
+        }
+    }
 
+    int rc = verify_states(solver, results, count, samples, thread_count);
+    free(results);
+    return rc;
+}
 
-        if (find_roll_stats(&game)->value == game.score) {
-            printf("stop\n");
-            break;
+// States are given as (score, dice, used_flags) triples, like query
+static int verify_listed_states(const solver_s* solver, char** args, size_t arg_count, size_t samples, size_t thread_count)
+{
+    size_t count = arg_count / 3;
+    verify_result_s* results = calloc(count, sizeof(verify_result_s));
+
+    for (size_t idx = 0; idx < count; ++idx) {
+        pickomino_roll_state_s* state = &results[idx].state;
+        pickomino_roll_init(state);
+        state->score = strtoul(args[3 * idx], NULL, 10);
+        state->dices_remaining = strtoul(args[3 * idx + 1], NULL, 10);
+        state->used_flags = strtoul(args[3 * idx + 2], NULL, 0);
+
+        if (!solver_has_state(solver, state)) {
+            fprintf(stderr, "Not a valid roll state: %s %s %s\n", args[3 * idx], args[3 * idx + 1], args[3 * idx + 2]);
+            free(results);
+            return 1;
         }
+    }
 
-        dice_state_s dice;
-        random_init();
-        do_random_roll(&dice, game.dices_remaining);
-        printf("roll: %s\n", format_roll(&dice));
+    int rc = verify_states(solver, results, count, samples, thread_count);
+    free(results);
+    return rc;
+}
 
-        bool have_action = false;
-        double max_state_action_value = 0;
+static solver_s* solve(unsigned flags)
+{
+    solver_s* solver = solver_create(flags);
+    assert(solver != NULL);
 
-        unsigned available_actions = pickomino_roll_available_actions(&game, &dice);
-        for (unsigned action = 0; available_actions; available_actions >>= 1, ++action) {
-            if ((available_actions & 0x1) == 0) continue;
+    printf("State space size: %u\n", (unsigned)solver->total_roll_stats_count);
+    solver_solve(solver);
+    return solver;
+}
 
-            tmp = game;
-            pickomino_roll_action(&tmp, &dice, action);
-            roll_stats_s* stats = find_roll_stats(&tmp);
+// Times everything a one-off query pays for, including creating the solver
+static int query_state(unsigned flags, const pickomino_roll_state_s* state)
+{
+    clock_t begin = clock();
+    solver_s* solver = solver_create(flags);
+    assert(solver != NULL);
+
+    if (!solver_has_state(solver, state)) {
+        fprintf(stderr, "Not a valid roll state\n");
+        solver_destroy(solver);
+        return 1;
+    }
 
-            if (!have_action || stats->value > max_state_action_value) {
-                max_action = tmp;
-                max_state_action_value = stats->value;
-                max_action_idx = action;
-                have_action = true;
-            }
+    size_t touched = solver_evaluate(solver, state);
+    clock_t end = clock();
 
-            printf("action: %c -> %s\n", g_pickomino_face_symbols[action], format_state(&tmp));
-        }
+    printf("%s: solved %u of %u states in %.3f ms\n",
+           format_state(solver, state),
+           (unsigned)touched, (unsigned)solver->total_roll_stats_count,
+           1000.0 * (end - begin) / CLOCKS_PER_SEC);
 
-        if (!have_action) {
-            printf("bust!\n");
-            break;
-        }
+    solver_destroy(solver);
+    return 0;
+}
 
-        game = max_action;
-        printf("do: %c\n\n", g_pickomino_face_symbols[max_action_idx]);
+static int build_tablebase(const char* path, unsigned max_tiles)
+{
+    clock_t begin = clock();
+    pickomino_tablebase_s* tb = pickomino_tablebase_generate(max_tiles);
+    clock_t end = clock();
+    if (!tb) {
+        fprintf(stderr, "Tablebase did not converge\n");
+        return 1;
+    }
+
+    printf("Tablebase with up to %u tiles: %u entries in %.2f s\n",
+           max_tiles, (unsigned)tb->entry_count, (double)(end - begin) / CLOCKS_PER_SEC);
+
+    // Sample: only the two highest tiles left, both stacks empty.
+    pickomino_game_state_s g;
+    pickomino_game_init(&g, 2);
+    for (size_t tile = 0; tile < PICKOMINO_ROLL_REWARD_DIM - MIN(max_tiles, 2); ++tile) {
+        g.tile_states[tile] = PICKOMINO_TILE_REMOVED;
+    }
+    for (int diff = -4; diff <= 4; diff += 2) {
+        pickomino_tablebase_entry_s e;
+        g.player_scores[0] = 4 + diff;
+        g.player_scores[1] = 4;
+        if (pickomino_tablebase_probe(tb, &g, &e)) {
+            printf("  diff %+d: win %.3f, target %u\n", diff, e.win_prob, e.target_score);
+        }
     }
+
+    bool ok = pickomino_tablebase_save(tb, path);
+    if (!ok) fprintf(stderr, "Could not write %s\n", path);
+    pickomino_tablebase_destroy(tb);
+    return ok ? 0 : 1;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+            "usage: %s [--huge-pages] [mode]\n"
+            "modes:\n"
+            "  (none)                            solve and play a single turn\n"
+            "  simulate <log> <games> [players]  write a binary log of full games\n"
+            "  dump <log>                        replay a binary log as text\n"
+            "  verify [samples] [threads] [score dice used_flags]...\n"
+            "                                    check the solved table by simulation (default: all states)\n"
+            "  query [score dice used_flags]     lazily solve a single state (default: turn start)\n"
+            "  tablebase <file> [max_tiles]      build a two player endgame tablebase\n",
+            name);
 }
 
 int main(int argc, char **argv)
 {
-    setup();
-    printf("State space size: %u\n", (unsigned)g_total_roll_stats_count);
+    unsigned solver_flags = 0;
+    if (argc >= 2 && strcmp(argv[1], "--huge-pages") == 0) {
+        solver_flags |= SOLVER_HUGE_PAGES;
+        argv[1] = argv[0];
+        --argc;
+        ++argv;
+    }
 
-    size_t round = 1;
-    for (size_t flag_count = TOTAL_DICE_FACES + 1; flag_count-- != 0; ++round)
-    {
-        printf("Round %d\n", (int)round);
-        for (size_t used_flags = 0; used_flags < TOTAL_USED_STATES; ++used_flags)
-        {
-            if (pop_count(used_flags) != flag_count) continue;
-            roll_stats_flags_dim_s* roll_stats_flags_dim = &s_roll_stats[used_flags];
-            for (size_t dice_id = 0; dice_id < roll_stats_flags_dim->dice_dim; ++dice_id) {
-                roll_stats_dice_dim_s* roll_stats_dice_dim = &roll_stats_flags_dim->values[dice_id];
-                size_t dice_remaining = roll_stats_flags_dim->min_dice_remaining + dice_id;
-                for (size_t score_id = 0; score_id < roll_stats_dice_dim->score_dim; ++score_id) {
-                    pickomino_roll_state_s state = {
-                        .dices_remaining = dice_remaining,
-                        .score = roll_stats_dice_dim->min_score + score_id,
-                        .used_flags = used_flags,
-                        .roll_hist = {},
-                    };
-                    update(&state);
-                }
-            }
+    if (argc >= 3 && strcmp(argv[1], "dump") == 0) {
+        return dump_log(argv[2]);
+    }
+
+    int rc;
+    if (argc >= 4 && strcmp(argv[1], "simulate") == 0) {
+        size_t game_count = strtoul(argv[3], NULL, 10);
+        unsigned player_count = argc >= 5 ? strtoul(argv[4], NULL, 10) : 2;
+        if (player_count < 1 || player_count > PICKOMINO_MAX_PLAYERS) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        solver_s* solver = solve(solver_flags);
+        rc = simulate_games(solver, argv[2], game_count, player_count);
+        solver_destroy(solver);
+        return rc;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "verify") == 0) {
+        size_t samples = argc >= 3 ? strtoul(argv[2], NULL, 10) : VERIFY_DEFAULT_SAMPLES;
+        size_t thread_count = argc >= 4 ? strtoul(argv[3], NULL, 10) : VERIFY_DEFAULT_THREADS;
+        size_t state_args = argc >= 4 ? argc - 4 : 0;
+        if (samples < 2 || state_args % 3 != 0) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        solver_s* solver = solve(solver_flags);
+        if (state_args) rc = verify_listed_states(solver, &argv[4], state_args, samples, thread_count);
+        else rc = verify_all_states(solver, samples, thread_count);
+        solver_destroy(solver);
+        return rc;
+    }
+
+    if (argc >= 2 && strcmp(argv[1], "query") == 0) {
+        pickomino_roll_state_s state;
+        pickomino_roll_init(&state);
+        if (argc >= 5) {
+            state.score = strtoul(argv[2], NULL, 10);
+            state.dices_remaining = strtoul(argv[3], NULL, 10);
+            state.used_flags = strtoul(argv[4], NULL, 0);
+        } else if (argc != 2) {
+            usage(argv[0]);
+            return 1;
+        }
+
+        return query_state(solver_flags, &state);
+    }
+
+    if (argc >= 3 && strcmp(argv[1], "tablebase") == 0) {
+        unsigned max_tiles = argc >= 4 ? strtoul(argv[3], NULL, 10) : TABLEBASE_DEFAULT_TILES;
+        if (max_tiles < 1 || max_tiles > PICKOMINO_TABLEBASE_MAX_TILES) {
+            usage(argv[0]);
+            return 1;
         }
+
+        return build_tablebase(argv[2], max_tiles);
+    }
+
+    if (argc != 1) {
+        usage(argv[0]);
+        return 1;
     }
 
-    play_game();
+    solver_s* solver = solve(solver_flags);
+    play_game(solver);
+    solver_destroy(solver);
+    return 0;
 }
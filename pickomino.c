@@ -1,8 +1,6 @@
 #include "pickomino.h"
 #include <assert.h>
 
-#define PICKOMINO_TILE_NONE 0xFF
-
 const uint8_t g_pickomino_face_scores[TOTAL_DICE_FACES] = { 1, 2, 3, 4, 5, 5 };
 const char g_pickomino_face_symbols[TOTAL_DICE_FACES] = {'1', '2', '3', '4', '5', 'W'};
 
@@ -114,23 +112,32 @@ static void push_tile_stack(pickomino_game_state_s* g, size_t player_id, uint8_t
     g->player_scores[player_id] += g_pickomino_roll_rewards[tile];
 }
 
-static void remove_top_tile(pickomino_game_state_s* g, uint8_t returned_tile)
+static uint8_t remove_top_tile(pickomino_game_state_s* g, uint8_t returned_tile)
 {
     // Remove top tile (if it was not just removed)
     for (size_t idx = PICKOMINO_ROLL_REWARD_DIM; idx-- != 0; ) {
         if (g->tile_states[idx] == PICKOMINO_TILE_AVAILABLE) {
-            if (returned_tile != idx) g->tile_states[idx] = PICKOMINO_TILE_REMOVED;
-            break;
+            if (returned_tile == idx) break;
+            g->tile_states[idx] = PICKOMINO_TILE_REMOVED;
+            return idx;
         }
     }
+    return PICKOMINO_TILE_NONE;
 }
 
-static bool try_steal_tile(pickomino_game_state_s* g, uint8_t tile)
+static bool try_steal_tile(pickomino_game_state_s* g, uint8_t tile, pickomino_tile_transfer_s* t)
 {
     for (size_t player_id = 0; player_id < g->player_count; ++player_id) {
+        if (player_id == g->cur_player_id) continue;
         if (peek_tile_stack(g, player_id) == tile) {
             pop_tile_stack(g, player_id);
             push_tile_stack(g, g->cur_player_id, tile);
+            *t = (pickomino_tile_transfer_s){
+                .kind = PICKOMINO_TRANSFER_STEAL,
+                .tile = tile,
+                .victim_id = player_id,
+                .removed_tile = PICKOMINO_TILE_NONE
+            };
             return true;
         }
     }
@@ -138,35 +145,57 @@ static bool try_steal_tile(pickomino_game_state_s* g, uint8_t tile)
     return false;
 }
 
-static bool pick_closest_tile(pickomino_game_state_s* g, uint8_t tile)
+static bool pick_closest_tile(pickomino_game_state_s* g, uint8_t tile, pickomino_tile_transfer_s* t)
 {
-    for (size_t idx = tile; idx-- != 0; ) {
+    for (size_t idx = MIN(tile + 1u, PICKOMINO_ROLL_REWARD_DIM); idx-- != 0; ) {
         if (g->tile_states[idx] == PICKOMINO_TILE_AVAILABLE) {
             push_tile_stack(g, g->cur_player_id, idx);
+            *t = (pickomino_tile_transfer_s){
+                .kind = PICKOMINO_TRANSFER_TAKE,
+                .tile = idx,
+                .victim_id = PICKOMINO_TILE_NONE,
+                .removed_tile = PICKOMINO_TILE_NONE
+            };
             return true;
         }
     }
     return false;
 }
 
-static void process_bust(pickomino_game_state_s* g)
+static void process_bust(pickomino_game_state_s* g, pickomino_tile_transfer_s* t)
 {
+    *t = (pickomino_tile_transfer_s){
+        .kind = PICKOMINO_TRANSFER_NONE,
+        .tile = PICKOMINO_TILE_NONE,
+        .victim_id = PICKOMINO_TILE_NONE,
+        .removed_tile = PICKOMINO_TILE_NONE
+    };
+
     uint8_t returned_tile = peek_tile_stack(g, g->cur_player_id);
     if (returned_tile != PICKOMINO_TILE_NONE) {
         pop_tile_stack(g, g->cur_player_id);
-        remove_top_tile(g, returned_tile);
+        t->kind = PICKOMINO_TRANSFER_RETURN;
+        t->tile = returned_tile;
+        t->removed_tile = remove_top_tile(g, returned_tile);
     }
 }
 
-void pickomino_game_process_roll(pickomino_game_state_s* g, unsigned roll_score)
+pickomino_tile_transfer_s pickomino_game_process_roll(pickomino_game_state_s* g, unsigned roll_score)
 {
+    pickomino_tile_transfer_s t;
     if (roll_score >= PICKOMINO_ROLL_REWARD_SCORE_BEGIN) {
         uint8_t tile = roll_score - PICKOMINO_ROLL_REWARD_SCORE_BEGIN;
-        if (try_steal_tile(g, tile)) return;
-        if (pick_closest_tile(g, tile)) return;
+        if (try_steal_tile(g, tile, &t)) return t;
+        if (pick_closest_tile(g, tile, &t)) return t;
     }
 
-    process_bust(g);
+    process_bust(g, &t);
+    return t;
+}
+
+void pickomino_game_next_player(pickomino_game_state_s* g)
+{
+    g->cur_player_id = (g->cur_player_id + 1) % g->player_count;
 }
 
 bool pickomino_game_is_done(const pickomino_game_state_s* g)
@@ -13,6 +13,7 @@
 #define PICKOMINO_TOTAL_ACTIONS TOTAL_DICE_FACES
 #define PICKOMINO_REQUIRED_ACTION (TOTAL_DICE_FACES - 1)
 #define PICKOMINO_ROLL_BUSTED 0
+#define PICKOMINO_TILE_NONE 0xFF
 
 extern const uint8_t g_pickomino_face_scores[TOTAL_DICE_FACES];
 extern const char g_pickomino_face_symbols[TOTAL_DICE_FACES];
@@ -24,6 +25,20 @@ typedef enum pickomino_tile_state_ {
     PICKOMINO_TILE_REMOVED
 } pickomino_tile_state_e;
 
+typedef enum pickomino_transfer_kind_ {
+    PICKOMINO_TRANSFER_NONE,    // Busted without owning a tile
+    PICKOMINO_TRANSFER_TAKE,    // Tile taken from the center
+    PICKOMINO_TRANSFER_STEAL,   // Tile stolen from the top of another player's stack
+    PICKOMINO_TRANSFER_RETURN   // Busted, top tile returned to the center
+} pickomino_transfer_kind_e;
+
+typedef struct {
+    pickomino_transfer_kind_e kind;
+    uint8_t tile;
+    uint8_t victim_id;          // Only for PICKOMINO_TRANSFER_STEAL
+    uint8_t removed_tile;       // Only for PICKOMINO_TRANSFER_RETURN, may be PICKOMINO_TILE_NONE
+} pickomino_tile_transfer_s;
+
 typedef struct {
     uint8_t player_stacks[PICKOMINO_MAX_PLAYERS][PICKOMINO_ROLL_REWARD_DIM];
     unsigned player_scores[PICKOMINO_MAX_PLAYERS];
@@ -54,6 +69,7 @@ bool pickomino_is_finalizeable(const pickomino_roll_state_s* r);
 unsigned pickomino_roll_finalize(const pickomino_roll_state_s* r);
 
 void pickomino_game_init(pickomino_game_state_s* g, int players);
-void pickomino_game_process_roll(pickomino_game_state_s* g, unsigned roll_score);
+pickomino_tile_transfer_s pickomino_game_process_roll(pickomino_game_state_s* g, unsigned roll_score);
+void pickomino_game_next_player(pickomino_game_state_s* g);
 bool pickomino_game_is_done(const pickomino_game_state_s* g);
 #endif
\ No newline at end of file
@@ -0,0 +1,312 @@
+#include "pickomino_log.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define LOG_MAGIC "PKL1"
+#define LOG_MAGIC_LEN 4
+#define LOG_MAX_EVENT_LEN 3
+
+static const char* s_transfer_names[] = {"none", "take", "steal", "return"};
+
+
+static void writer_flush(pickomino_log_writer_s* w)
+{
+    if (!w->len) return;
+
+    // Events after a failed write are dropped, destroy reports the error
+    if (!w->error && fwrite(w->buf, w->len, 1, w->fp) != 1) w->error = true;
+    w->len = 0;
+}
+
+static inline uint8_t* writer_reserve(pickomino_log_writer_s* w, size_t len)
+{
+    if (w->len + len > PICKOMINO_LOG_BUF_SIZE) writer_flush(w);
+
+    uint8_t* out = &w->buf[w->len];
+    w->len += len;
+    return out;
+}
+
+static inline void writer_put_event(pickomino_log_writer_s* w, pickomino_log_event_type_e type, unsigned arg)
+{
+    assert(arg < 16);
+    *writer_reserve(w, 1) = (type << 4) | arg;
+}
+
+pickomino_log_writer_s* pickomino_log_writer_create(const char* path)
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return NULL;
+
+    pickomino_log_writer_s* w = calloc(1, sizeof(pickomino_log_writer_s));
+    w->fp = fp;
+    memcpy(writer_reserve(w, LOG_MAGIC_LEN), LOG_MAGIC, LOG_MAGIC_LEN);
+    return w;
+}
+
+bool pickomino_log_writer_destroy(pickomino_log_writer_s* w)
+{
+    if (!w) return false;
+
+    writer_flush(w);
+    bool ok = fclose(w->fp) == 0 && !w->error;
+    free(w);
+    return ok;
+}
+
+void pickomino_log_game_begin(pickomino_log_writer_s* w, unsigned player_count)
+{
+    writer_put_event(w, PICKOMINO_LOG_GAME_BEGIN, player_count);
+}
+
+void pickomino_log_roll(pickomino_log_writer_s* w, const dice_state_s* dice)
+{
+    unsigned dice_count = 0;
+    for (size_t face = 0; face < TOTAL_DICE_FACES; ++face) {
+        dice_count += dice->face_counts[face];
+    }
+
+    size_t index = dice_state_index(dice);
+    assert(index <= UINT16_MAX);
+
+    uint8_t* out = writer_reserve(w, 3);
+    out[0] = (PICKOMINO_LOG_ROLL << 4) | dice_count;
+    out[1] = index & 0xFF;
+    out[2] = index >> 8;
+}
+
+void pickomino_log_action(pickomino_log_writer_s* w, unsigned action)
+{
+    writer_put_event(w, PICKOMINO_LOG_ACTION, action);
+}
+
+void pickomino_log_stop(pickomino_log_writer_s* w)
+{
+    writer_put_event(w, PICKOMINO_LOG_STOP, 0);
+}
+
+void pickomino_log_bust(pickomino_log_writer_s* w)
+{
+    writer_put_event(w, PICKOMINO_LOG_BUST, 0);
+}
+
+void pickomino_log_transfer(pickomino_log_writer_s* w, const pickomino_tile_transfer_s* t)
+{
+    uint8_t* out = writer_reserve(w, 3);
+    out[0] = (PICKOMINO_LOG_TRANSFER << 4) | t->kind;
+    out[1] = t->tile;
+    out[2] = t->kind == PICKOMINO_TRANSFER_STEAL ? t->victim_id : t->removed_tile;
+}
+
+void pickomino_log_game_end(pickomino_log_writer_s* w)
+{
+    writer_put_event(w, PICKOMINO_LOG_GAME_END, 0);
+}
+
+
+static bool reader_get(pickomino_log_reader_s* r, uint8_t* out, size_t len)
+{
+    assert(len <= LOG_MAX_EVENT_LEN || len == LOG_MAGIC_LEN);
+
+    if (r->len - r->pos < len) {
+        size_t left = r->len - r->pos;
+        memmove(r->buf, &r->buf[r->pos], left);
+        r->len = left + fread(&r->buf[left], 1, PICKOMINO_LOG_BUF_SIZE - left, r->fp);
+        r->pos = 0;
+        if (ferror(r->fp)) r->error = true;
+        if (r->len < len) return false;
+    }
+
+    memcpy(out, &r->buf[r->pos], len);
+    r->pos += len;
+    return true;
+}
+
+pickomino_log_reader_s* pickomino_log_reader_create(const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    pickomino_log_reader_s* r = calloc(1, sizeof(pickomino_log_reader_s));
+    r->fp = fp;
+
+    uint8_t magic[LOG_MAGIC_LEN];
+    if (!reader_get(r, magic, LOG_MAGIC_LEN) || memcmp(magic, LOG_MAGIC, LOG_MAGIC_LEN) != 0) {
+        pickomino_log_reader_destroy(r);
+        return NULL;
+    }
+
+    return r;
+}
+
+void pickomino_log_reader_destroy(pickomino_log_reader_s* r)
+{
+    if (!r) return;
+
+    fclose(r->fp);
+    free(r);
+}
+
+static bool decode_event(pickomino_log_reader_s* r, uint8_t head, pickomino_log_event_s* ev)
+{
+    uint8_t payload[2];
+
+    *ev = (pickomino_log_event_s){.type = head >> 4, .arg = head & 0xF};
+    switch (ev->type) {
+    case PICKOMINO_LOG_ROLL:
+        if (!reader_get(r, payload, 2)) return false;
+        if (ev->arg > PICKOMINO_TOTAL_DICES) return false;
+
+        size_t index = payload[0] | (payload[1] << 8);
+        if (index >= dice_state_count(ev->arg)) return false;
+        dice_state_from_index(&ev->dice, ev->arg, index);
+        return true;
+
+    case PICKOMINO_LOG_TRANSFER:
+        if (!reader_get(r, payload, 2)) return false;
+        if (ev->arg > PICKOMINO_TRANSFER_RETURN) return false;
+
+        ev->transfer = (pickomino_tile_transfer_s){
+            .kind = ev->arg,
+            .tile = payload[0],
+            .victim_id = ev->arg == PICKOMINO_TRANSFER_STEAL ? payload[1] : PICKOMINO_TILE_NONE,
+            .removed_tile = ev->arg == PICKOMINO_TRANSFER_STEAL ? PICKOMINO_TILE_NONE : payload[1]
+        };
+        return true;
+
+    case PICKOMINO_LOG_GAME_BEGIN:
+        return ev->arg >= 1 && ev->arg <= PICKOMINO_MAX_PLAYERS;
+
+    case PICKOMINO_LOG_ACTION:
+        return ev->arg < PICKOMINO_TOTAL_ACTIONS;
+
+    case PICKOMINO_LOG_STOP:
+    case PICKOMINO_LOG_BUST:
+    case PICKOMINO_LOG_GAME_END:
+        return true;
+    }
+
+    return false;
+}
+
+bool pickomino_log_reader_next(pickomino_log_reader_s* r, pickomino_log_event_s* ev)
+{
+    uint8_t head;
+    if (r->error) return false;
+    if (!reader_get(r, &head, 1)) return false;
+
+    if (!decode_event(r, head, ev)) r->error = true;
+    return !r->error;
+}
+
+
+static unsigned tile_score(uint8_t tile)
+{
+    return tile + PICKOMINO_ROLL_REWARD_SCORE_BEGIN;
+}
+
+static bool transfer_equal(const pickomino_tile_transfer_s* a, const pickomino_tile_transfer_s* b)
+{
+    if (a->kind != b->kind || a->tile != b->tile) return false;
+    if (a->kind == PICKOMINO_TRANSFER_STEAL) return a->victim_id == b->victim_id;
+    return a->removed_tile == b->removed_tile;
+}
+
+static void format_transfer(FILE* out, const pickomino_game_state_s* g, const pickomino_tile_transfer_s* t)
+{
+    fprintf(out, "tile: %s", s_transfer_names[t->kind]);
+    if (t->kind != PICKOMINO_TRANSFER_NONE) fprintf(out, " %u", tile_score(t->tile));
+    if (t->kind == PICKOMINO_TRANSFER_STEAL) fprintf(out, " from player %u", t->victim_id);
+    if (t->kind == PICKOMINO_TRANSFER_RETURN && t->removed_tile != PICKOMINO_TILE_NONE) {
+        fprintf(out, ", removed %u", tile_score(t->removed_tile));
+    }
+    fprintf(out, " (player %u has %u worms)\n\n", g->cur_player_id, g->player_scores[g->cur_player_id]);
+}
+
+bool pickomino_log_replay(pickomino_log_reader_s* r, FILE* text_out)
+{
+    pickomino_game_state_s game;
+    pickomino_roll_state_s roll;
+    dice_state_s dice = {};
+    bool in_game = false;
+    bool turn_done = false;
+    bool have_roll = false;
+    unsigned roll_score = PICKOMINO_ROLL_BUSTED;
+    char tpl[32];
+
+    pickomino_log_event_s ev;
+    while (pickomino_log_reader_next(r, &ev)) {
+        switch (ev.type) {
+        case PICKOMINO_LOG_GAME_BEGIN:
+            if (in_game) return false;
+            pickomino_game_init(&game, ev.arg);
+            pickomino_roll_init(&roll);
+            in_game = true;
+            turn_done = false;
+            have_roll = false;
+            if (text_out) fprintf(text_out, "game: %u players\n\n", ev.arg);
+            break;
+
+        case PICKOMINO_LOG_ROLL:
+            if (!in_game || turn_done || have_roll || pickomino_game_is_done(&game)) return false;
+            if (ev.arg != roll.dices_remaining) return false;
+            dice = ev.dice;
+            have_roll = true;
+            if (text_out) {
+                pickomino_roll_format(&dice, tpl, sizeof(tpl));
+                fprintf(text_out, "roll: %s\n", tpl);
+            }
+            break;
+
+        case PICKOMINO_LOG_ACTION:
+            if (!have_roll) return false;
+            if ((pickomino_roll_available_actions(&roll, &dice) & (1u << ev.arg)) == 0) return false;
+            pickomino_roll_action(&roll, &dice, ev.arg);
+            have_roll = false;
+            if (text_out) fprintf(text_out, "do: %c -> %u\n", g_pickomino_face_symbols[ev.arg], roll.score);
+            break;
+
+        case PICKOMINO_LOG_STOP:
+            if (!in_game || turn_done || have_roll) return false;
+            roll_score = pickomino_roll_finalize(&roll);
+            turn_done = true;
+            if (text_out) fprintf(text_out, "stop: %u\n", roll_score);
+            break;
+
+        case PICKOMINO_LOG_BUST:
+            if (!have_roll || pickomino_roll_available_actions(&roll, &dice) != 0) return false;
+            roll_score = PICKOMINO_ROLL_BUSTED;
+            turn_done = true;
+            have_roll = false;
+            if (text_out) fprintf(text_out, "bust!\n");
+            break;
+
+        case PICKOMINO_LOG_TRANSFER: {
+            if (!turn_done) return false;
+            pickomino_tile_transfer_s expected = pickomino_game_process_roll(&game, roll_score);
+            if (!transfer_equal(&expected, &ev.transfer)) return false;
+            if (text_out) format_transfer(text_out, &game, &expected);
+
+            pickomino_game_next_player(&game);
+            pickomino_roll_init(&roll);
+            turn_done = false;
+            break;
+        }
+
+        case PICKOMINO_LOG_GAME_END:
+            if (!in_game || turn_done || have_roll || !pickomino_game_is_done(&game)) return false;
+            in_game = false;
+            if (text_out) {
+                fprintf(text_out, "end:");
+                for (size_t player_id = 0; player_id < game.player_count; ++player_id) {
+                    fprintf(text_out, " %u", game.player_scores[player_id]);
+                }
+                fprintf(text_out, "\n\n");
+            }
+            break;
+        }
+    }
+
+    return !r->error && !in_game;
+}
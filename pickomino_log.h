@@ -0,0 +1,68 @@
+#ifndef INCLUDED_PICKOMINO_LOG_H_
+#define INCLUDED_PICKOMINO_LOG_H_
+
+#include "constants.h"
+#include "dice_combinations.h"
+#include "pickomino.h"
+#include <stdio.h>
+
+#define PICKOMINO_LOG_BUF_SIZE 65536
+
+// Every event starts with a single byte: the event type in the high nibble and
+// a small argument in the low nibble. Rolls are followed by a 16 bit outcome index
+// (see dice_state_index), transfers by the tile and the victim / removed tile.
+typedef enum pickomino_log_event_type_ {
+    PICKOMINO_LOG_GAME_BEGIN = 1,   // arg: player count
+    PICKOMINO_LOG_ROLL,             // arg: dice count
+    PICKOMINO_LOG_ACTION,           // arg: chosen face
+    PICKOMINO_LOG_STOP,
+    PICKOMINO_LOG_BUST,
+    PICKOMINO_LOG_TRANSFER,         // arg: pickomino_transfer_kind_e
+    PICKOMINO_LOG_GAME_END
+} pickomino_log_event_type_e;
+
+typedef struct {
+    pickomino_log_event_type_e type;
+    unsigned arg;
+    dice_state_s dice;
+    pickomino_tile_transfer_s transfer;
+} pickomino_log_event_s;
+
+typedef struct {
+    FILE* fp;
+    size_t len;
+    bool error;             // Sticky: set by the first failed write
+    uint8_t buf[PICKOMINO_LOG_BUF_SIZE];
+} pickomino_log_writer_s;
+
+typedef struct {
+    FILE* fp;
+    size_t pos;
+    size_t len;
+    bool error;             // Sticky: set on a read error or an event that fails to decode
+    uint8_t buf[PICKOMINO_LOG_BUF_SIZE];
+} pickomino_log_reader_s;
+
+pickomino_log_writer_s* pickomino_log_writer_create(const char* path);
+// Flushes and closes the log. Returns false if any write failed.
+bool pickomino_log_writer_destroy(pickomino_log_writer_s* w);
+void pickomino_log_game_begin(pickomino_log_writer_s* w, unsigned player_count);
+void pickomino_log_roll(pickomino_log_writer_s* w, const dice_state_s* dice);
+void pickomino_log_action(pickomino_log_writer_s* w, unsigned action);
+void pickomino_log_stop(pickomino_log_writer_s* w);
+void pickomino_log_bust(pickomino_log_writer_s* w);
+void pickomino_log_transfer(pickomino_log_writer_s* w, const pickomino_tile_transfer_s* t);
+void pickomino_log_game_end(pickomino_log_writer_s* w);
+
+pickomino_log_reader_s* pickomino_log_reader_create(const char* path);
+void pickomino_log_reader_destroy(pickomino_log_reader_s* r);
+// Returns false at the end of the log or on a truncated, corrupt or unreadable
+// event; the two are told apart by r->error.
+bool pickomino_log_reader_next(pickomino_log_reader_s* r, pickomino_log_event_s* ev);
+
+// Replays all remaining events through the game engine, checking that every
+// action is legal and every logged transfer matches the engine. Writes a text
+// trace to text_out if it is not NULL. Returns false on the first mismatch or
+// decode error, or if the log ends inside a game.
+bool pickomino_log_replay(pickomino_log_reader_s* r, FILE* text_out);
+#endif
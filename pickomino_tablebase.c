@@ -0,0 +1,606 @@
+#include "pickomino_tablebase.h"
+#include "dice_combinations.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#define TABLEBASE_MAGIC "PKTB"
+#define TABLEBASE_MAGIC_LEN 4
+#define TABLEBASE_VERSION 1
+#define TABLEBASE_HEADER_LEN 12
+#define TABLEBASE_EPSILON 1e-9
+#define TABLEBASE_MAX_ITERATIONS 10000
+
+#define TOP_NONE PICKOMINO_ROLL_REWARD_DIM
+#define TARGET_COUNT PICKOMINO_ROLL_REWARD_DIM
+#define SCORE_DIM (PICKOMINO_MAX_SCORE + 1)
+#define PROB_BITS 12
+#define PROB_MAX ((1u << PROB_BITS) - 1)
+
+#define TURN_FLAGS_DIM (1u << TOTAL_DICE_FACES)
+#define TURN_DICE_DIM (PICKOMINO_TOTAL_DICES + 1)
+#define REQUIRED_FLAG (1u << PICKOMINO_REQUIRED_ACTION)
+// Actions whose chances only differ by rounding are ties, the first one wins
+#define TURN_TIE_EPSILON 1e-12
+
+typedef struct
+{
+    double dist[SCORE_DIM];     // Final score, 0 is a bust
+    double p_success;
+    bool done;
+} turn_memo_s;
+
+typedef struct
+{
+    dice_state_cache_s* dice_states[PICKOMINO_TOTAL_DICES];
+    turn_memo_s* memo;
+    unsigned target;
+} turn_ctx_s;
+
+typedef struct
+{
+    double p_bust;
+    double p_steal;
+    size_t take_count;
+    uint8_t take_tiles[PICKOMINO_ROLL_REWARD_DIM];
+    size_t take_subsets[PICKOMINO_ROLL_REWARD_DIM];
+    double take_probs[PICKOMINO_ROLL_REWARD_DIM];
+} turn_outcome_s;
+
+typedef struct
+{
+    pickomino_tablebase_s* tb;
+    double* values;
+    uint8_t* targets;
+    double turn_dists[TARGET_COUNT][SCORE_DIM];
+} generator_s;
+
+
+static unsigned pop_count(unsigned v)
+{
+    unsigned c = 0;
+    for (; v; v >>= 1) c += v & 1;
+    return c;
+}
+
+static unsigned highest_bit(unsigned v)
+{
+    unsigned idx = 0;
+    while (v >>= 1) ++idx;
+    return idx;
+}
+
+static void tablebase_init(pickomino_tablebase_s* tb, unsigned max_tiles)
+{
+    tb->max_tiles = max_tiles;
+
+    for (size_t n = 0; n <= PICKOMINO_ROLL_REWARD_DIM; ++n) {
+        for (size_t k = 0; k <= PICKOMINO_TABLEBASE_MAX_TILES; ++k) {
+            if (k == 0) tb->binomials[n][k] = 1;
+            else if (n == 0) tb->binomials[n][k] = 0;
+            else tb->binomials[n][k] = tb->binomials[n - 1][k - 1] + tb->binomials[n - 1][k];
+        }
+    }
+
+    tb->subset_offsets[0] = 0;
+    for (size_t k = 0; k <= max_tiles; ++k) {
+        tb->subset_offsets[k + 1] = tb->subset_offsets[k] + tb->binomials[PICKOMINO_ROLL_REWARD_DIM][k];
+    }
+
+    tb->entry_count = tb->subset_offsets[max_tiles + 1]
+                    * PICKOMINO_TABLEBASE_TOP_DIM * PICKOMINO_TABLEBASE_TOP_DIM * PICKOMINO_TABLEBASE_DIFF_DIM;
+}
+
+// Subsets are ranked by size first, then in colexicographic order.
+static size_t subset_index(const pickomino_tablebase_s* tb, unsigned tiles)
+{
+    size_t rank = 0;
+    size_t count = 0;
+    for (unsigned tile = 0; tiles; tiles >>= 1, ++tile) {
+        if (tiles & 1) rank += tb->binomials[tile][++count];
+    }
+
+    return tb->subset_offsets[count] + rank;
+}
+
+static size_t position_index(size_t subset, unsigned mover_top, unsigned other_top, int diff)
+{
+    size_t idx = subset * PICKOMINO_TABLEBASE_TOP_DIM + mover_top;
+    idx = idx * PICKOMINO_TABLEBASE_TOP_DIM + other_top;
+    return idx * PICKOMINO_TABLEBASE_DIFF_DIM + (diff + PICKOMINO_TABLEBASE_MAX_DIFF);
+}
+
+static size_t entry_index(const pickomino_tablebase_s* tb, unsigned tiles, unsigned mover_top, unsigned other_top, int diff)
+{
+    return position_index(subset_index(tb, tiles), mover_top, other_top, diff);
+}
+
+static int clamp_diff(int diff)
+{
+    return MAX(MIN(diff, PICKOMINO_TABLEBASE_MAX_DIFF), -PICKOMINO_TABLEBASE_MAX_DIFF);
+}
+
+static double terminal_value(int diff)
+{
+    return diff > 0 ? 1.0 : diff == 0 ? 0.5 : 0.0;
+}
+
+
+// Turn played towards ctx->target, picking the action with the best chance to get there
+static const turn_memo_s* turn_eval(turn_ctx_s* ctx, unsigned flags, unsigned dice, unsigned score)
+{
+    turn_memo_s* m = &ctx->memo[(flags * TURN_DICE_DIM + dice) * SCORE_DIM + score];
+    if (m->done) return m;
+    m->done = true;
+
+    if ((flags & REQUIRED_FLAG) && score >= ctx->target) {
+        m->dist[score] = 1;
+        m->p_success = 1;
+        return m;
+    }
+
+    // Out of dice or faces: the roll still counts if a worm was kept
+    if (dice == 0 || flags == TURN_FLAGS_DIM - 1) {
+        m->dist[(flags & REQUIRED_FLAG) ? score : PICKOMINO_ROLL_BUSTED] = 1;
+        return m;
+    }
+
+    const turn_memo_s* children[PICKOMINO_TOTAL_ACTIONS][PICKOMINO_TOTAL_DICES] = {};
+    double weights[PICKOMINO_TOTAL_ACTIONS][PICKOMINO_TOTAL_DICES] = {};
+    double p_bust = 0;
+
+    const dice_state_cache_s* dice_cache = ctx->dice_states[dice - 1];
+    for (size_t dice_idx = 0; dice_idx < dice_cache->count; ++dice_idx) {
+        const dice_state_s* d = &dice_cache->states[dice_idx];
+        const turn_memo_s* best = NULL;
+        double* best_weight = NULL;
+
+        for (size_t action = 0; action < PICKOMINO_TOTAL_ACTIONS; ++action) {
+            unsigned count = d->face_counts[action];
+            if ((flags & (1u << action)) || count == 0) continue;
+
+            const turn_memo_s** child = &children[action][count - 1];
+            if (!*child) {
+                *child = turn_eval(ctx, flags | (1u << action), dice - count, score + count * g_pickomino_face_scores[action]);
+            }
+
+            if (!best || (*child)->p_success > best->p_success + TURN_TIE_EPSILON) {
+                best = *child;
+                best_weight = &weights[action][count - 1];
+            }
+        }
+
+        if (best) *best_weight += d->prob;
+        else p_bust += d->prob;
+    }
+
+    m->dist[PICKOMINO_ROLL_BUSTED] = p_bust;
+    for (size_t action = 0; action < PICKOMINO_TOTAL_ACTIONS; ++action) {
+        for (size_t count = 0; count < dice; ++count) {
+            double w = weights[action][count];
+            if (w == 0) continue;
+
+            const turn_memo_s* child = children[action][count];
+            for (size_t s = 0; s < SCORE_DIM; ++s) m->dist[s] += w * child->dist[s];
+            m->p_success += w * child->p_success;
+        }
+    }
+
+    return m;
+}
+
+static void turn_ctx_init(turn_ctx_s* ctx)
+{
+    *ctx = (turn_ctx_s){.memo = malloc(TURN_FLAGS_DIM * TURN_DICE_DIM * SCORE_DIM * sizeof(turn_memo_s))};
+    for (size_t dice_id = 0; dice_id < PICKOMINO_TOTAL_DICES; ++dice_id) {
+        ctx->dice_states[dice_id] = dice_state_cache_create(dice_id + 1);
+    }
+}
+
+static void turn_ctx_destroy(turn_ctx_s* ctx)
+{
+    for (size_t dice_id = 0; dice_id < PICKOMINO_TOTAL_DICES; ++dice_id) {
+        dice_state_cache_destroy(ctx->dice_states[dice_id]);
+    }
+    free(ctx->memo);
+}
+
+static void turn_dist_eval(turn_ctx_s* ctx, unsigned target_score, double* dist)
+{
+    memset(ctx->memo, 0, TURN_FLAGS_DIM * TURN_DICE_DIM * SCORE_DIM * sizeof(turn_memo_s));
+    ctx->target = target_score;
+
+    const turn_memo_s* start = turn_eval(ctx, 0, PICKOMINO_TOTAL_DICES, 0);
+    memcpy(dist, start->dist, sizeof(start->dist));
+}
+
+static void turn_dists_init(generator_s* gen)
+{
+    turn_ctx_s ctx;
+    turn_ctx_init(&ctx);
+    for (size_t t = 0; t < TARGET_COUNT; ++t) {
+        turn_dist_eval(&ctx, PICKOMINO_ROLL_REWARD_SCORE_BEGIN + t, gen->turn_dists[t]);
+    }
+    turn_ctx_destroy(&ctx);
+}
+
+void pickomino_tablebase_turn_dist(unsigned target_score, double* dist)
+{
+    assert(target_score >= PICKOMINO_ROLL_REWARD_SCORE_BEGIN);
+    assert(target_score < PICKOMINO_ROLL_REWARD_SCORE_BEGIN + TARGET_COUNT);
+
+    turn_ctx_s ctx;
+    turn_ctx_init(&ctx);
+    turn_dist_eval(&ctx, target_score, dist);
+    turn_ctx_destroy(&ctx);
+}
+
+
+// Groups the final scores of a turn by what they do to the board, following
+// pickomino_game_process_roll: steal the opponent's top, else take the closest
+// tile at or below the score, else bust.
+static void turn_outcome_init(const pickomino_tablebase_s* tb, turn_outcome_s* o, const double* dist, unsigned tiles, unsigned other_top)
+{
+    *o = (turn_outcome_s){.p_bust = dist[PICKOMINO_ROLL_BUSTED]};
+
+    double p_take[PICKOMINO_ROLL_REWARD_DIM] = {};
+    for (unsigned s = PICKOMINO_ROLL_BUSTED + 1; s < SCORE_DIM; ++s) {
+        if (dist[s] == 0) continue;
+        if (s < PICKOMINO_ROLL_REWARD_SCORE_BEGIN) {
+            o->p_bust += dist[s];
+            continue;
+        }
+
+        unsigned tile = s - PICKOMINO_ROLL_REWARD_SCORE_BEGIN;
+        if (other_top != TOP_NONE && tile == other_top) {
+            o->p_steal += dist[s];
+            continue;
+        }
+
+        unsigned below = tiles & ((2u << MIN(tile, PICKOMINO_ROLL_REWARD_DIM - 1)) - 1);
+        if (below) p_take[highest_bit(below)] += dist[s];
+        else o->p_bust += dist[s];
+    }
+
+    for (unsigned tile = 0; tile < PICKOMINO_ROLL_REWARD_DIM; ++tile) {
+        if (p_take[tile] == 0) continue;
+        o->take_tiles[o->take_count] = tile;
+        o->take_subsets[o->take_count] = subset_index(tb, tiles & ~(1u << tile));
+        o->take_probs[o->take_count] = p_take[tile];
+        ++o->take_count;
+    }
+}
+
+// The returned tile goes back to the center and the highest tile is turned over,
+// unless the returned tile is the highest one: it then stays and the center grows
+// by one tile. At the top level there is no room for that, the returned tile is
+// taken out of the game instead.
+static unsigned bust_tiles(const pickomino_tablebase_s* tb, unsigned tiles, unsigned mover_top)
+{
+    if (mover_top == TOP_NONE) return tiles;
+
+    unsigned returned = tiles | (1u << mover_top);
+    unsigned highest = highest_bit(returned);
+    if (highest != mover_top) return returned & ~(1u << highest);
+    return pop_count(tiles) < tb->max_tiles ? returned : tiles;
+}
+
+static double lookup(const generator_s* gen, size_t subset, unsigned mover_top, unsigned other_top, int diff)
+{
+    return gen->values[position_index(subset, mover_top, other_top, clamp_diff(diff))];
+}
+
+// Splits the value of each target into a fixed part and the probability of
+// moving to the partner position, which is only separate when both stacks have
+// no top: busting then just hands the same board to the opponent.
+static void position_terms(const generator_s* gen, const turn_outcome_s* outcomes, unsigned tiles, size_t subset,
+                           unsigned mover_top, unsigned other_top, int diff, double* fixed, double* to_partner)
+{
+    bool has_partner = mover_top == TOP_NONE && other_top == TOP_NONE;
+    size_t bust_subset = subset_index(gen->tb, bust_tiles(gen->tb, tiles, mover_top));
+
+    for (size_t t = 0; t < TARGET_COUNT; ++t) {
+        const turn_outcome_s* o = &outcomes[t];
+        double v = 0;
+
+        if (o->p_steal > 0) {
+            int stolen = diff + 2 * g_pickomino_roll_rewards[other_top];
+            v += o->p_steal * (1 - lookup(gen, subset, TOP_NONE, other_top, -stolen));
+        }
+
+        for (size_t idx = 0; idx < o->take_count; ++idx) {
+            unsigned tile = o->take_tiles[idx];
+            int taken = diff + g_pickomino_roll_rewards[tile];
+            v += o->take_probs[idx] * (1 - lookup(gen, o->take_subsets[idx], other_top, tile, -taken));
+        }
+
+        to_partner[t] = has_partner ? o->p_bust : 0;
+        if (!has_partner && o->p_bust > 0) {
+            int busted = diff - (mover_top == TOP_NONE ? 0 : g_pickomino_roll_rewards[mover_top]);
+            v += o->p_bust * (1 - lookup(gen, bust_subset, other_top, TOP_NONE, -busted));
+        }
+
+        fixed[t] = v;
+    }
+}
+
+static uint8_t best_target(const double* fixed, const double* to_partner, double partner_value, double* value)
+{
+    uint8_t best = 0;
+    *value = -1;
+    for (size_t t = 0; t < TARGET_COUNT; ++t) {
+        double v = fixed[t] + to_partner[t] * (1 - partner_value);
+        if (v > *value) {
+            *value = v;
+            best = t;
+        }
+    }
+    return best;
+}
+
+// Both players without a top at +diff and -diff only lead into each other by
+// busting. Solved exactly by policy iteration instead of by the outer sweep,
+// which would converge with the (often tiny) chance of leaving the cycle.
+static double solve_pair(generator_s* gen, const turn_outcome_s* outcomes, unsigned tiles, size_t subset, int diff)
+{
+    double fixed[2][TARGET_COUNT], to_partner[2][TARGET_COUNT];
+    size_t idx[2];
+    for (size_t side = 0; side < 2; ++side) {
+        int d = side ? -diff : diff;
+        idx[side] = position_index(subset, TOP_NONE, TOP_NONE, d);
+        position_terms(gen, outcomes, tiles, subset, TOP_NONE, TOP_NONE, d, fixed[side], to_partner[side]);
+    }
+
+    double old[2] = {gen->values[idx[0]], gen->values[idx[1]]};
+    double v[2] = {old[0], old[1]};
+    uint8_t policy[2] = {gen->targets[idx[0]], gen->targets[idx[1]]};
+
+    for (size_t iteration = 0; iteration < TARGET_COUNT * TARGET_COUNT; ++iteration) {
+        double a0 = fixed[0][policy[0]], b0 = to_partner[0][policy[0]];
+        double a1 = fixed[1][policy[1]], b1 = to_partner[1][policy[1]];
+        if (diff == 0) {
+            v[0] = v[1] = (a0 + b0) / (1 + b0);
+        } else {
+            v[0] = (a0 + b0 * (1 - a1 - b1)) / (1 - b0 * b1);
+            v[1] = a1 + b1 * (1 - v[0]);
+        }
+
+        double unused;
+        uint8_t next[2] = {
+            best_target(fixed[0], to_partner[0], v[1], &unused),
+            best_target(fixed[1], to_partner[1], v[0], &unused),
+        };
+        if (next[0] == policy[0] && next[1] == policy[1]) break;
+        policy[0] = next[0];
+        policy[1] = next[1];
+    }
+
+    for (size_t side = 0; side < 2; ++side) {
+        gen->values[idx[side]] = v[side];
+        gen->targets[idx[side]] = policy[side];
+    }
+    return MAX(fabs(v[0] - old[0]), fabs(v[1] - old[1]));
+}
+
+static bool is_valid_top(unsigned tiles, unsigned top)
+{
+    return top == TOP_NONE || (tiles & (1u << top)) == 0;
+}
+
+// One Gauss-Seidel sweep over the positions with tile_count tiles, returns the
+// largest change.
+static double sweep_level(generator_s* gen, unsigned tile_count)
+{
+    const unsigned all_tiles = (1u << PICKOMINO_ROLL_REWARD_DIM) - 1;
+    turn_outcome_s outcomes[TARGET_COUNT];
+    double fixed[TARGET_COUNT], to_partner[TARGET_COUNT];
+    double max_delta = 0;
+
+    for (unsigned tiles = 0; tiles <= all_tiles; ++tiles) {
+        if (pop_count(tiles) != tile_count) continue;
+        size_t subset = subset_index(gen->tb, tiles);
+
+        for (unsigned other_top = 0; other_top < PICKOMINO_TABLEBASE_TOP_DIM; ++other_top) {
+            if (!is_valid_top(tiles, other_top)) continue;
+
+            for (size_t t = 0; t < TARGET_COUNT; ++t) {
+                turn_outcome_init(gen->tb, &outcomes[t], gen->turn_dists[t], tiles, other_top);
+            }
+
+            if (other_top == TOP_NONE) {
+                for (int diff = 0; diff <= PICKOMINO_TABLEBASE_MAX_DIFF; ++diff) {
+                    max_delta = MAX(max_delta, solve_pair(gen, outcomes, tiles, subset, diff));
+                }
+            }
+
+            for (unsigned mover_top = 0; mover_top < PICKOMINO_TABLEBASE_TOP_DIM; ++mover_top) {
+                if (!is_valid_top(tiles, mover_top)) continue;
+                if (mover_top == other_top) continue;
+
+                for (int diff = -PICKOMINO_TABLEBASE_MAX_DIFF; diff <= PICKOMINO_TABLEBASE_MAX_DIFF; ++diff) {
+                    size_t idx = position_index(subset, mover_top, other_top, diff);
+                    double v;
+                    position_terms(gen, outcomes, tiles, subset, mover_top, other_top, diff, fixed, to_partner);
+                    gen->targets[idx] = best_target(fixed, to_partner, 0, &v);
+                    max_delta = MAX(max_delta, fabs(v - gen->values[idx]));
+                    gen->values[idx] = v;
+                }
+            }
+        }
+    }
+
+    return max_delta;
+}
+
+// Steals and busts lead to positions with the same tile count, taking a tile
+// leads to the level below and a bust returning the highest tile to the level
+// above, so all levels are swept together, bottom up, until none of them changes.
+static bool solve_levels(generator_s* gen, unsigned max_tiles)
+{
+    for (size_t iteration = 0; iteration < TABLEBASE_MAX_ITERATIONS; ++iteration) {
+        double max_delta = 0;
+        for (unsigned tile_count = 1; tile_count <= max_tiles; ++tile_count) {
+            max_delta = MAX(max_delta, sweep_level(gen, tile_count));
+        }
+
+        if (max_delta < TABLEBASE_EPSILON) return true;
+    }
+    return false;
+}
+
+pickomino_tablebase_s* pickomino_tablebase_generate(unsigned max_tiles)
+{
+    if (max_tiles > PICKOMINO_TABLEBASE_MAX_TILES) return NULL;
+
+    pickomino_tablebase_s* tb = calloc(1, sizeof(pickomino_tablebase_s));
+    tablebase_init(tb, max_tiles);
+
+    generator_s* gen = calloc(1, sizeof(generator_s));
+    gen->tb = tb;
+    gen->values = calloc(tb->entry_count, sizeof(double));
+    gen->targets = calloc(tb->entry_count, sizeof(uint8_t));
+    turn_dists_init(gen);
+
+    for (int diff = -PICKOMINO_TABLEBASE_MAX_DIFF; diff <= PICKOMINO_TABLEBASE_MAX_DIFF; ++diff) {
+        for (unsigned mover_top = 0; mover_top < PICKOMINO_TABLEBASE_TOP_DIM; ++mover_top) {
+            for (unsigned other_top = 0; other_top < PICKOMINO_TABLEBASE_TOP_DIM; ++other_top) {
+                gen->values[entry_index(tb, 0, mover_top, other_top, diff)] = terminal_value(diff);
+            }
+        }
+    }
+
+    if (!solve_levels(gen, max_tiles)) {
+        free(gen->targets);
+        free(gen->values);
+        free(gen);
+        pickomino_tablebase_destroy(tb);
+        return NULL;
+    }
+
+    tb->entries = calloc(tb->entry_count, sizeof(uint16_t));
+    for (size_t idx = 0; idx < tb->entry_count; ++idx) {
+        unsigned q = (unsigned)lround(MAX(MIN(gen->values[idx], 1.0), 0.0) * PROB_MAX);
+        tb->entries[idx] = (q << 4) | gen->targets[idx];
+    }
+
+    free(gen->targets);
+    free(gen->values);
+    free(gen);
+    return tb;
+}
+
+void pickomino_tablebase_destroy(pickomino_tablebase_s* tb)
+{
+    if (!tb) return;
+
+    free(tb->entries);
+    free(tb);
+}
+
+
+static void put_u32(uint8_t* out, uint32_t v)
+{
+    for (size_t idx = 0; idx < 4; ++idx) out[idx] = v >> (8 * idx);
+}
+
+static uint32_t get_u32(const uint8_t* in)
+{
+    uint32_t v = 0;
+    for (size_t idx = 0; idx < 4; ++idx) v |= (uint32_t)in[idx] << (8 * idx);
+    return v;
+}
+
+bool pickomino_tablebase_save(const pickomino_tablebase_s* tb, const char* path)
+{
+    FILE* fp = fopen(path, "wb");
+    if (!fp) return false;
+
+    uint8_t header[TABLEBASE_HEADER_LEN];
+    memcpy(header, TABLEBASE_MAGIC, TABLEBASE_MAGIC_LEN);
+    header[4] = TABLEBASE_VERSION;
+    header[5] = tb->max_tiles;
+    header[6] = PICKOMINO_TABLEBASE_MAX_DIFF;
+    header[7] = PICKOMINO_TABLEBASE_TOP_DIM;
+    put_u32(&header[8], tb->entry_count);
+
+    uint8_t* body = malloc(2 * tb->entry_count);
+    for (size_t idx = 0; idx < tb->entry_count; ++idx) {
+        body[2 * idx] = tb->entries[idx] & 0xFF;
+        body[2 * idx + 1] = tb->entries[idx] >> 8;
+    }
+
+    bool ok = fwrite(header, sizeof(header), 1, fp) == 1
+           && fwrite(body, 2 * tb->entry_count, 1, fp) == 1;
+    free(body);
+    return fclose(fp) == 0 && ok;
+}
+
+pickomino_tablebase_s* pickomino_tablebase_load(const char* path)
+{
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return NULL;
+
+    uint8_t header[TABLEBASE_HEADER_LEN];
+    if (fread(header, sizeof(header), 1, fp) != 1
+        || memcmp(header, TABLEBASE_MAGIC, TABLEBASE_MAGIC_LEN) != 0
+        || header[4] != TABLEBASE_VERSION
+        || header[5] > PICKOMINO_TABLEBASE_MAX_TILES
+        || header[6] != PICKOMINO_TABLEBASE_MAX_DIFF
+        || header[7] != PICKOMINO_TABLEBASE_TOP_DIM) {
+        fclose(fp);
+        return NULL;
+    }
+
+    pickomino_tablebase_s* tb = calloc(1, sizeof(pickomino_tablebase_s));
+    tablebase_init(tb, header[5]);
+
+    uint8_t* body = malloc(2 * tb->entry_count);
+    bool ok = get_u32(&header[8]) == tb->entry_count
+           && fread(body, 2 * tb->entry_count, 1, fp) == 1;
+    fclose(fp);
+
+    if (ok) {
+        tb->entries = malloc(tb->entry_count * sizeof(uint16_t));
+        for (size_t idx = 0; idx < tb->entry_count; ++idx) {
+            tb->entries[idx] = body[2 * idx] | (body[2 * idx + 1] << 8);
+        }
+    }
+
+    free(body);
+    if (!ok) {
+        pickomino_tablebase_destroy(tb);
+        return NULL;
+    }
+    return tb;
+}
+
+
+static unsigned stack_top(const pickomino_game_state_s* g, size_t player_id)
+{
+    unsigned stack_size = g->player_stack_size[player_id];
+    return stack_size ? g->player_stacks[player_id][stack_size - 1] : TOP_NONE;
+}
+
+bool pickomino_tablebase_probe(const pickomino_tablebase_s* tb, const pickomino_game_state_s* g, pickomino_tablebase_entry_s* out)
+{
+    if (g->player_count != 2) return false;
+
+    unsigned tiles = 0;
+    for (unsigned tile = 0; tile < PICKOMINO_ROLL_REWARD_DIM; ++tile) {
+        if (g->tile_states[tile] == PICKOMINO_TILE_AVAILABLE) tiles |= 1u << tile;
+    }
+    if (pop_count(tiles) > tb->max_tiles) return false;
+
+    unsigned mover = g->cur_player_id;
+    unsigned other = 1 - mover;
+    int diff = (int)g->player_scores[mover] - (int)g->player_scores[other];
+
+    uint16_t entry = tb->entries[entry_index(tb, tiles, stack_top(g, mover), stack_top(g, other), clamp_diff(diff))];
+    *out = (pickomino_tablebase_entry_s){
+        .win_prob = (double)(entry >> 4) / PROB_MAX,
+        .target_score = PICKOMINO_ROLL_REWARD_SCORE_BEGIN + (entry & 0xF),
+    };
+    return true;
+}
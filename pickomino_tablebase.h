@@ -0,0 +1,52 @@
+#ifndef INCLUDED_PICKOMINO_TABLEBASE_H_
+#define INCLUDED_PICKOMINO_TABLEBASE_H_
+
+#include "constants.h"
+#include "pickomino.h"
+
+#define PICKOMINO_TABLEBASE_MAX_TILES 4
+#define PICKOMINO_TABLEBASE_MAX_DIFF 24
+#define PICKOMINO_TABLEBASE_TOP_DIM (PICKOMINO_ROLL_REWARD_DIM + 1)
+#define PICKOMINO_TABLEBASE_DIFF_DIM (2 * PICKOMINO_TABLEBASE_MAX_DIFF + 1)
+
+// Two player endgames with at most max_tiles tiles left in the center. A position
+// is keyed by the set of available tiles, the top tile of the player to move and
+// of the opponent, and the worm difference (clamped to +/- MAX_DIFF). Tiles below
+// a stack top are not part of the key: once a top is stolen or returned, the
+// stack is treated as having no top. A turn is played towards a target score:
+// keep rolling to maximize the chance of reaching it, stop as soon as it is
+// reached with a worm. Each entry holds the win probability of the player to move
+// (draws count half) and the best target. A bust returning a tile above every
+// center tile grows the center by one; at max_tiles that tile is taken out of
+// the game instead, so values at the top level (and, through them, slightly
+// those below) are approximate for positions where the mover's top is above
+// the center.
+typedef struct
+{
+    unsigned max_tiles;
+    size_t subset_offsets[PICKOMINO_TABLEBASE_MAX_TILES + 2];
+    uint32_t binomials[PICKOMINO_ROLL_REWARD_DIM + 1][PICKOMINO_TABLEBASE_MAX_TILES + 1];
+    size_t entry_count;
+    uint16_t* entries;
+} pickomino_tablebase_s;
+
+typedef struct
+{
+    double win_prob;
+    unsigned target_score;
+} pickomino_tablebase_entry_s;
+
+// Returns NULL if max_tiles is out of range or a level does not converge.
+pickomino_tablebase_s* pickomino_tablebase_generate(unsigned max_tiles);
+pickomino_tablebase_s* pickomino_tablebase_load(const char* path);
+bool pickomino_tablebase_save(const pickomino_tablebase_s* tb, const char* path);
+void pickomino_tablebase_destroy(pickomino_tablebase_s* tb);
+
+// Looks up the position of the current player. Returns false if the game is not a
+// two player game or has more available tiles than the tablebase covers.
+bool pickomino_tablebase_probe(const pickomino_tablebase_s* tb, const pickomino_game_state_s* g, pickomino_tablebase_entry_s* out);
+
+// Final score distribution (index 0 is a bust) of a turn played towards
+// target_score, as used by the generator. dist holds PICKOMINO_MAX_SCORE + 1 scores.
+void pickomino_tablebase_turn_dist(unsigned target_score, double* dist);
+#endif
@@ -4,8 +4,9 @@
 
 #define BUF_SIZE 1024
 
-static uint16_t s_buf[BUF_SIZE];
-static uint16_t* s_cur;
+// Per thread, every thread calls random_init() before drawing
+static _Thread_local uint16_t s_buf[BUF_SIZE];
+static _Thread_local uint16_t* s_cur;
 
 static void refresh()
 {
@@ -14,17 +15,14 @@ static void refresh()
 
     size_t count = fread(&s_buf, sizeof(s_buf), 1, fp);
     assert(count == 1);
+    fclose(fp);
+
+    s_cur = s_buf;
 }
 
 void random_init()
 {
-    FILE* fp = fopen("/dev/urandom", "r");
-    assert(fp != NULL);
-
-    size_t count = fread(&s_buf, sizeof(s_buf), 1, fp);
-    assert(count == 1);
-
-    s_cur = s_buf;
+    refresh();
 }
 
 void random_uniform(uint8_t end_value, uint8_t* begin, size_t count)
@@ -0,0 +1,391 @@
+#include "solver.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+// The AVX2 kernel is compiled for the target on its own and picked at runtime
+#if defined(__x86_64__) || defined(__i386__)
+#define SOLVER_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+#define REQUIRED_FACE (TOTAL_DICE_FACES - 1)
+#define SOLVER_ARENA_CAPACITY (16u << 20)
+
+#define ROLL_KERNEL_LANES 4
+#define ROLL_KERNEL_NO_ACTION INT16_MIN
+#define ROLL_STATS_STRIDE (sizeof(roll_stats_s) / sizeof(double))
+
+static unsigned pop_count(unsigned v)
+{
+    unsigned c = 0;
+    do { c += (v & 1); } while (v >>= 1);
+    return c;
+}
+
+static void* solver_calloc(solver_s* s, size_t count, size_t size)
+{
+    void* p = arena_calloc(s->arena, count, size);
+    assert(p != NULL && "SOLVER_ARENA_CAPACITY exceeded");
+    return p;
+}
+
+static void roll_stats_dice_dim_init(roll_stats_dice_dim_s* l, size_t min_score, size_t max_score)
+{
+    l->min_score = min_score;
+    l->score_dim = (max_score - min_score) + 1;
+}
+
+static void roll_stats_flags_dim_init(solver_s* s, roll_stats_flags_dim_s* r, unsigned used_flags)
+{
+    size_t min_dice_idx = SIZE_MAX;
+    size_t max_dice_idx = SIZE_MAX;
+    size_t min_score = 0;
+    size_t min_dice_used = 0;
+
+    for (size_t idx = 0; idx < TOTAL_DICE_FACES; ++idx) {
+        if (((1u << idx) & used_flags) == 0) continue;
+        if (min_dice_idx != SIZE_MAX) min_dice_idx = idx;
+
+        ++min_dice_used;
+        max_dice_idx = idx;
+        min_score += g_pickomino_face_scores[idx];
+    }
+
+    size_t max_dice_used = used_flags == 0 ? 0 : PICKOMINO_TOTAL_DICES;
+    size_t dice_dim = (max_dice_used - min_dice_used) + 1;
+
+    r->values = solver_calloc(s, dice_dim, sizeof(roll_stats_dice_dim_s));
+    r->dice_dim = dice_dim;
+    r->min_dice_remaining = PICKOMINO_TOTAL_DICES - max_dice_used;
+
+    size_t min_score_per_dice = min_dice_idx == SIZE_MAX ? 0 : g_pickomino_face_scores[min_dice_idx];
+    size_t max_score_per_dice = max_dice_idx == SIZE_MAX ? 0 : g_pickomino_face_scores[max_dice_idx];
+    for (size_t idx = 0; idx < dice_dim; ++idx) {
+        size_t list_min_score = min_score + min_score_per_dice * (dice_dim - idx - 1);
+        size_t list_max_score = min_score + max_score_per_dice * (dice_dim - idx - 1);
+        roll_stats_dice_dim_init(&r->values[idx], list_min_score, list_max_score);
+        r->total_stats_count += r->values[idx].score_dim;
+    }
+}
+
+static void roll_stats_pool_init(solver_s* s)
+{
+    // One contiguous block, so the kernels can address children by index
+    s->roll_stats_pool = solver_calloc(s, s->total_roll_stats_count, sizeof(roll_stats_s));
+    s->roll_stats_solved = solver_calloc(s, s->total_roll_stats_count, sizeof(uint8_t));
+    s->solved_epoch = 1;
+
+    roll_stats_s* next = s->roll_stats_pool;
+    for (unsigned flags = 0; flags < SOLVER_USED_STATES; ++flags) {
+        roll_stats_flags_dim_s* r = &s->roll_stats[flags];
+        for (size_t idx = 0; idx < r->dice_dim; ++idx) {
+            r->values[idx].values = next;
+            next += r->values[idx].score_dim;
+        }
+    }
+}
+
+static roll_stats_dice_dim_s* find_roll_stats_dice_dim(const solver_s* s, unsigned used_flags, unsigned dices_remaining);
+
+static size_t roll_kernel_outcome_count(size_t dice_count)
+{
+    return (dice_state_count(dice_count) + ROLL_KERNEL_LANES - 1) / ROLL_KERNEL_LANES * ROLL_KERNEL_LANES;
+}
+
+static void roll_kernel_init(solver_s* s, roll_kernel_s* k, unsigned used_flags, unsigned dices_remaining)
+{
+    const dice_state_cache_s* dice_cache = &s->dice_states[dices_remaining - 1];
+    k->outcome_count = roll_kernel_outcome_count(dices_remaining);
+    k->probs = s->roll_probs[dices_remaining - 1];
+
+    for (size_t action = 0; action < PICKOMINO_TOTAL_ACTIONS; ++action) {
+        if (used_flags & (1u << action)) continue;
+
+        // The child only depends on how many dice show the face
+        int16_t child_offsets[PICKOMINO_TOTAL_DICES + 1] = {ROLL_KERNEL_NO_ACTION};
+        for (unsigned face_count = 1; face_count <= dices_remaining; ++face_count) {
+            const roll_stats_dice_dim_s* child = find_roll_stats_dice_dim(s, used_flags | (1u << action), dices_remaining - face_count);
+            child_offsets[face_count] = (int16_t)((child->values - s->roll_stats_pool) - (ptrdiff_t)child->min_score
+                                                  + (ptrdiff_t)(face_count * g_pickomino_face_scores[action]));
+        }
+
+        int16_t* offsets = solver_calloc(s, k->outcome_count, sizeof(int16_t));
+        for (size_t dice_idx = 0; dice_idx < k->outcome_count; ++dice_idx) {
+            bool is_padding = dice_idx >= dice_cache->count;
+            offsets[dice_idx] = is_padding ? ROLL_KERNEL_NO_ACTION : child_offsets[dice_cache->states[dice_idx].face_counts[action]];
+        }
+        k->offsets[action] = offsets;
+    }
+}
+
+static void setup(solver_s* s)
+{
+    for (size_t dice_id = 0; dice_id < PICKOMINO_TOTAL_DICES; ++dice_id) {
+        dice_state_s* states = solver_calloc(s, dice_state_count(dice_id + 1), sizeof(dice_state_s));
+        dice_state_cache_init(&s->dice_states[dice_id], dice_id + 1, states);
+
+        s->roll_probs[dice_id] = solver_calloc(s, roll_kernel_outcome_count(dice_id + 1), sizeof(double));
+        for (size_t dice_idx = 0; dice_idx < s->dice_states[dice_id].count; ++dice_idx) {
+            s->roll_probs[dice_id][dice_idx] = states[dice_idx].prob;
+        }
+    }
+
+    s->total_roll_stats_count = 0;
+    for (unsigned flags = 0; flags < SOLVER_USED_STATES; ++flags) {
+        roll_stats_flags_dim_init(s, &s->roll_stats[flags], flags);
+        s->total_roll_stats_count += s->roll_stats[flags].total_stats_count;
+    }
+
+    roll_stats_pool_init(s);
+
+    // Kernel offsets are relative to the pool and stored in 16 bits
+    assert(s->total_roll_stats_count + PICKOMINO_MAX_SCORE < INT16_MAX);
+}
+
+bool solver_has_state(const solver_s* s, const pickomino_roll_state_s* r)
+{
+    if (r->used_flags >= SOLVER_USED_STATES) return false;
+    const roll_stats_flags_dim_s* l1 = &s->roll_stats[r->used_flags];
+
+    if (r->dices_remaining < l1->min_dice_remaining) return false;
+    if (r->dices_remaining - l1->min_dice_remaining >= l1->dice_dim) return false;
+    const roll_stats_dice_dim_s* l2 = &l1->values[r->dices_remaining - l1->min_dice_remaining];
+
+    return r->score >= l2->min_score && r->score - l2->min_score < l2->score_dim;
+}
+
+roll_stats_s* solver_find_roll_stats(const solver_s* s, const pickomino_roll_state_s* r)
+{
+    assert(r->used_flags < SOLVER_USED_STATES);
+    const roll_stats_flags_dim_s* l1 = &s->roll_stats[r->used_flags];
+
+    assert(r->dices_remaining - l1->min_dice_remaining < l1->dice_dim);
+    const roll_stats_dice_dim_s* l2 = &l1->values[r->dices_remaining - l1->min_dice_remaining];
+
+    assert(r->score - l2->min_score < l2->score_dim);
+    return &l2->values[r->score - l2->min_score];
+}
+
+static roll_stats_dice_dim_s* find_roll_stats_dice_dim(const solver_s* s, unsigned used_flags, unsigned dices_remaining)
+{
+    assert(used_flags < SOLVER_USED_STATES);
+    const roll_stats_flags_dim_s* l1 = &s->roll_stats[used_flags];
+
+    assert(dices_remaining - l1->min_dice_remaining < l1->dice_dim);
+    return &l1->values[dices_remaining - l1->min_dice_remaining];
+}
+
+#ifdef SOLVER_HAVE_AVX2
+// Evaluates ROLL_KERNEL_LANES outcomes at once: gathers the children of each
+// action and keeps the first action with the strictly highest value per lane.
+__attribute__((target("avx2")))
+static void roll_kernel_eval_avx2(const solver_s* s, const roll_kernel_s* k, unsigned score, double* value, double* p_bust)
+{
+    const __m128i no_action = _mm_set1_epi32(ROLL_KERNEL_NO_ACTION);
+    const __m128i score_v = _mm_set1_epi32(score);
+    const __m128i stride_v = _mm_set1_epi32(ROLL_STATS_STRIDE);
+    const double* values = &s->roll_stats_pool->value;
+    const double* p_busts = &s->roll_stats_pool->p_bust;
+
+    __m256d sum_value = _mm256_setzero_pd();
+    __m256d sum_p_bust = _mm256_setzero_pd();
+
+    for (size_t dice_idx = 0; dice_idx < k->outcome_count; dice_idx += ROLL_KERNEL_LANES) {
+        __m256d best_value = _mm256_set1_pd(-1.0);
+        __m256d best_p_bust = _mm256_set1_pd(1.0);
+
+        for (size_t action = 0; action < PICKOMINO_TOTAL_ACTIONS; ++action) {
+            if (!k->offsets[action]) continue;
+            __m128i offsets = _mm_cvtepi16_epi32(_mm_loadl_epi64((const __m128i*)&k->offsets[action][dice_idx]));
+            __m128i valid = _mm_xor_si128(_mm_cmpeq_epi32(offsets, no_action), _mm_set1_epi32(-1));
+            if (_mm_testz_si128(valid, valid)) continue;
+
+            __m128i idx = _mm_mullo_epi32(_mm_add_epi32(offsets, score_v), stride_v);
+            __m256d mask = _mm256_castsi256_pd(_mm256_cvtepi32_epi64(valid));
+            __m256d v = _mm256_mask_i32gather_pd(_mm256_set1_pd(-1.0), values, idx, mask, sizeof(double));
+            __m256d pb = _mm256_mask_i32gather_pd(best_p_bust, p_busts, idx, mask, sizeof(double));
+
+            __m256d gt = _mm256_cmp_pd(v, best_value, _CMP_GT_OQ);
+            best_value = _mm256_blendv_pd(best_value, v, gt);
+            best_p_bust = _mm256_blendv_pd(best_p_bust, pb, gt);
+        }
+
+        __m256d prob = _mm256_loadu_pd(&k->probs[dice_idx]);
+        best_value = _mm256_max_pd(best_value, _mm256_setzero_pd());
+        sum_value = _mm256_add_pd(sum_value, _mm256_mul_pd(prob, best_value));
+        sum_p_bust = _mm256_add_pd(sum_p_bust, _mm256_mul_pd(prob, best_p_bust));
+    }
+
+    double lanes[ROLL_KERNEL_LANES];
+    _mm256_storeu_pd(lanes, sum_value);
+    *value = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    _mm256_storeu_pd(lanes, sum_p_bust);
+    *p_bust = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+}
+#endif
+
+static void roll_kernel_eval_scalar(const solver_s* s, const roll_kernel_s* k, unsigned score, double* value, double* p_bust)
+{
+    double sum_value = 0;
+    double sum_p_bust = 0;
+
+    for (size_t dice_idx = 0; dice_idx < k->outcome_count; ++dice_idx) {
+        double best_value = -1.0;
+        double best_p_bust = 1.0;
+
+        for (size_t action = 0; action < PICKOMINO_TOTAL_ACTIONS; ++action) {
+            if (!k->offsets[action]) continue;
+            int32_t offset = k->offsets[action][dice_idx];
+            if (offset == ROLL_KERNEL_NO_ACTION) continue;
+
+            const roll_stats_s* child = &s->roll_stats_pool[(int32_t)score + offset];
+            if (child->value > best_value) {
+                best_value = child->value;
+                best_p_bust = child->p_bust;
+            }
+        }
+
+        sum_value += k->probs[dice_idx] * MAX(best_value, 0);
+        sum_p_bust += k->probs[dice_idx] * best_p_bust;
+    }
+
+    *value = sum_value;
+    *p_bust = sum_p_bust;
+}
+
+static void roll_kernel_eval(const solver_s* s, const roll_kernel_s* k, unsigned score, double* value, double* p_bust)
+{
+#ifdef SOLVER_HAVE_AVX2
+    if (s->use_avx2) {
+        roll_kernel_eval_avx2(s, k, score, value, p_bust);
+        return;
+    }
+#endif
+    roll_kernel_eval_scalar(s, k, score, value, p_bust);
+}
+
+static void update(solver_s* s, const pickomino_roll_state_s* src_game)
+{
+    bool has_required_face = src_game->used_flags & (1u << REQUIRED_FACE);
+    bool is_allowed_to_stop = has_required_face && src_game->score >= SOLVER_MIN_STOP_SCORE;
+    double state_stop_value = is_allowed_to_stop ? src_game->score : 0;
+    double state_stop_p_bust = is_allowed_to_stop ? 0 : 1;
+
+    double state_roll_value = 0;
+    double state_roll_p_bust = 1.0;
+
+    if (src_game->dices_remaining > 0 && src_game->used_flags != SOLVER_USED_STATES - 1) {
+        // Built on first use, so a lazy evaluation only pays for the kernels it needs
+        roll_kernel_s* k = &s->roll_kernels[src_game->used_flags][src_game->dices_remaining];
+        if (!k->probs) roll_kernel_init(s, k, src_game->used_flags, src_game->dices_remaining);
+        roll_kernel_eval(s, k, src_game->score, &state_roll_value, &state_roll_p_bust);
+    }
+
+    double new_value, new_p_bust;
+    if (state_roll_value > state_stop_value) {
+        new_value = state_roll_value;
+        new_p_bust = state_roll_p_bust;
+    } else {
+        new_value = state_stop_value;
+        new_p_bust = state_stop_p_bust;
+    }
+
+    roll_stats_s* src_stats = solver_find_roll_stats(s, src_game);
+    src_stats->value = new_value;
+    src_stats->p_bust = new_p_bust;
+    s->roll_stats_solved[src_stats - s->roll_stats_pool] = s->solved_epoch;
+}
+
+// Depth first: every child uses one more face, so the recursion is at most
+// TOTAL_DICE_FACES deep. A child only depends on the face taken and how many
+// dice showed it, not on the rest of the outcome.
+static size_t evaluate(solver_s* s, const pickomino_roll_state_s* r)
+{
+    const roll_stats_s* stats = solver_find_roll_stats(s, r);
+    if (s->roll_stats_solved[stats - s->roll_stats_pool] == s->solved_epoch) return 0;
+
+    size_t touched = 1;
+    if (r->used_flags != SOLVER_USED_STATES - 1) {
+        for (size_t action = 0; action < PICKOMINO_TOTAL_ACTIONS; ++action) {
+            if (r->used_flags & (1u << action)) continue;
+
+            for (unsigned face_count = 1; face_count <= r->dices_remaining; ++face_count) {
+                pickomino_roll_state_s child = {
+                    .dices_remaining = r->dices_remaining - face_count,
+                    .score = r->score + face_count * g_pickomino_face_scores[action],
+                    .used_flags = r->used_flags | (1u << action),
+                    .roll_hist = {},
+                };
+                touched += evaluate(s, &child);
+            }
+        }
+    }
+
+    update(s, r);
+    return touched;
+}
+
+solver_s* solver_create(unsigned flags)
+{
+    arena_s* arena = arena_create(SOLVER_ARENA_CAPACITY, flags & SOLVER_HUGE_PAGES);
+    if (!arena) return NULL;
+
+    solver_s* s = arena_alloc(arena, sizeof(solver_s));
+    s->arena = arena;
+#ifdef SOLVER_HAVE_AVX2
+    s->use_avx2 = !(flags & SOLVER_SCALAR) && __builtin_cpu_supports("avx2");
+#endif
+    setup(s);
+    return s;
+}
+
+void solver_destroy(solver_s* s)
+{
+    if (!s) return;
+
+    // The solver lives in its own arena
+    arena_destroy(s->arena);
+}
+
+size_t solver_evaluate(solver_s* s, const pickomino_roll_state_s* r)
+{
+    return evaluate(s, r);
+}
+
+void solver_solve(solver_s* s)
+{
+    for (size_t flag_count = TOTAL_DICE_FACES + 1; flag_count-- != 0; )
+    {
+        for (size_t used_flags = 0; used_flags < SOLVER_USED_STATES; ++used_flags)
+        {
+            if (pop_count(used_flags) != flag_count) continue;
+            roll_stats_flags_dim_s* roll_stats_flags_dim = &s->roll_stats[used_flags];
+            for (size_t dice_id = 0; dice_id < roll_stats_flags_dim->dice_dim; ++dice_id) {
+                roll_stats_dice_dim_s* roll_stats_dice_dim = &roll_stats_flags_dim->values[dice_id];
+                size_t dice_remaining = roll_stats_flags_dim->min_dice_remaining + dice_id;
+                for (size_t score_id = 0; score_id < roll_stats_dice_dim->score_dim; ++score_id) {
+                    // Already solved by solver_evaluate or an earlier sweep
+                    const roll_stats_s* stats = &roll_stats_dice_dim->values[score_id];
+                    if (s->roll_stats_solved[stats - s->roll_stats_pool] == s->solved_epoch) continue;
+
+                    pickomino_roll_state_s state = {
+                        .dices_remaining = dice_remaining,
+                        .score = roll_stats_dice_dim->min_score + score_id,
+                        .used_flags = used_flags,
+                        .roll_hist = {},
+                    };
+                    update(s, &state);
+                }
+            }
+        }
+    }
+}
+
+void solver_reset(solver_s* s)
+{
+    // A new epoch invalidates all flags at once; they only need clearing when it wraps
+    if (++s->solved_epoch == 0) {
+        memset(s->roll_stats_solved, 0, s->total_roll_stats_count);
+        s->solved_epoch = 1;
+    }
+}
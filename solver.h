@@ -0,0 +1,78 @@
+#ifndef INCLUDED_SOLVER_H_
+#define INCLUDED_SOLVER_H_
+
+#include "constants.h"
+#include "dice_combinations.h"
+#include "pickomino.h"
+#include "arena.h"
+
+#define SOLVER_USED_STATES 64
+#define SOLVER_MIN_STOP_SCORE 21
+#define SOLVER_HUGE_PAGES ARENA_HUGE_PAGES
+#define SOLVER_SCALAR 0x100u     // Use the scalar kernel even if the CPU has AVX2
+
+typedef struct
+{
+    double value;
+    double p_score[PICKOMINO_ROLL_REWARD_DIM];
+    double p_bust;
+} roll_stats_s;
+
+typedef struct
+{
+    roll_stats_s *values;
+    unsigned min_score;
+    unsigned score_dim;
+} roll_stats_dice_dim_s;
+
+typedef struct
+{
+    roll_stats_dice_dim_s* values;
+    size_t min_dice_remaining;
+    size_t dice_dim;
+    size_t total_stats_count;
+} roll_stats_flags_dim_s;
+
+// Transitions of all states sharing (used_flags, dices_remaining). Child stats
+// are found at roll_stats_pool[score + offsets[action][outcome]]; actions that
+// are already used have no offsets. Outcomes are padded to a multiple of
+// ROLL_KERNEL_LANES with zero probability, probs is shared by all kernels with
+// the same dice count. Built the first time a state of the group is updated.
+typedef struct
+{
+    int16_t* offsets[PICKOMINO_TOTAL_ACTIONS];
+    const double* probs;
+    size_t outcome_count;
+} roll_kernel_s;
+
+// A single turn solver. Everything, including the solver itself, lives in one
+// arena, so independent instances can be used side by side from different threads.
+typedef struct
+{
+    arena_s* arena;
+    dice_state_cache_s dice_states[PICKOMINO_TOTAL_DICES];
+    roll_stats_flags_dim_s roll_stats[SOLVER_USED_STATES];
+    roll_stats_s* roll_stats_pool;
+    uint8_t* roll_stats_solved;     // Equal to solved_epoch once solved
+    uint8_t solved_epoch;
+    double* roll_probs[PICKOMINO_TOTAL_DICES];
+    roll_kernel_s roll_kernels[SOLVER_USED_STATES][PICKOMINO_TOTAL_DICES + 1];
+    size_t total_roll_stats_count;
+    bool use_avx2;
+} solver_s;
+
+solver_s* solver_create(unsigned flags);
+void solver_destroy(solver_s* s);
+// Solves every state that is not solved yet
+void solver_solve(solver_s* s);
+
+// Forgets every solved state in O(1), so the instance can be solved again. The
+// dice tables and transition kernels only depend on the rules and are kept.
+void solver_reset(solver_s* s);
+
+// Solves only the states reachable from r, reusing everything solved before
+// (lazily or by solver_solve). Returns the number of states it had to solve.
+size_t solver_evaluate(solver_s* s, const pickomino_roll_state_s* r);
+bool solver_has_state(const solver_s* s, const pickomino_roll_state_s* r);
+roll_stats_s* solver_find_roll_stats(const solver_s* s, const pickomino_roll_state_s* r);
+#endif
@@ -0,0 +1,218 @@
+#include "random.h"
+#include "pickomino.h"
+#include "pickomino_log.h"
+
+#include <stdlib.h>
+#include <assert.h>
+#include <stdio.h>
+
+#define LOG_PATH "build/test/test_game_log.bin"
+#define GAME_COUNT 1000
+#define PLAYER_COUNT 3
+
+static void test_dice_index()
+{
+    for (size_t dice_count = 1; dice_count <= PICKOMINO_TOTAL_DICES; ++dice_count) {
+        dice_state_cache_s* c = dice_state_cache_create(dice_count);
+        assert(c->count == dice_state_count(dice_count));
+
+        for (size_t idx = 0; idx < c->count; ++idx) {
+            dice_state_s d;
+            assert(dice_state_index(&c->states[idx]) == idx);
+            dice_state_from_index(&d, dice_count, idx);
+            for (size_t face = 0; face < TOTAL_DICE_FACES; ++face) {
+                assert(d.face_counts[face] == c->states[idx].face_counts[face]);
+            }
+        }
+
+        printf("%u dice: %u outcomes\n", (unsigned)dice_count, (unsigned)c->count);
+        dice_state_cache_destroy(c);
+    }
+}
+
+static void roll(dice_state_s* d, size_t dice_count)
+{
+    uint8_t rolls[PICKOMINO_TOTAL_DICES];
+    random_uniform(TOTAL_DICE_FACES, rolls, dice_count);
+
+    *d = (dice_state_s){.face_counts = {}};
+    for (size_t idx = 0; idx < dice_count; ++idx) {
+        ++d->face_counts[rolls[idx]];
+    }
+}
+
+// Takes the highest scoring face and stops as soon as the roll counts.
+static unsigned play_greedy_turn(pickomino_log_writer_s* log)
+{
+    pickomino_roll_state_s r;
+    pickomino_roll_init(&r);
+
+    while (!pickomino_is_finalizeable(&r) || r.score < PICKOMINO_ROLL_REWARD_SCORE_BEGIN) {
+        dice_state_s d;
+        roll(&d, r.dices_remaining);
+        pickomino_log_roll(log, &d);
+
+        unsigned available = pickomino_roll_available_actions(&r, &d);
+        if (!available) {
+            pickomino_log_bust(log);
+            return PICKOMINO_ROLL_BUSTED;
+        }
+
+        unsigned action = TOTAL_DICE_FACES;
+        while (!(available & (1u << --action)));
+        pickomino_roll_action(&r, &d, action);
+        pickomino_log_action(log, action);
+    }
+
+    pickomino_log_stop(log);
+    return pickomino_roll_finalize(&r);
+}
+
+static void write_games()
+{
+    pickomino_log_writer_s* log = pickomino_log_writer_create(LOG_PATH);
+    assert(log != NULL);
+
+    for (size_t game_id = 0; game_id < GAME_COUNT; ++game_id) {
+        pickomino_game_state_s g;
+        pickomino_game_init(&g, PLAYER_COUNT);
+        pickomino_log_game_begin(log, PLAYER_COUNT);
+
+        while (!pickomino_game_is_done(&g)) {
+            pickomino_tile_transfer_s t = pickomino_game_process_roll(&g, play_greedy_turn(log));
+            pickomino_log_transfer(log, &t);
+            pickomino_game_next_player(&g);
+        }
+
+        pickomino_log_game_end(log);
+    }
+
+    bool written = pickomino_log_writer_destroy(log);
+    assert(written);
+    (void)written;
+}
+
+static void test_replay()
+{
+    random_init();
+    write_games();
+
+    pickomino_log_reader_s* r = pickomino_log_reader_create(LOG_PATH);
+    assert(r != NULL);
+    bool replayed = pickomino_log_replay(r, NULL);
+    assert(replayed);
+    (void)replayed;
+    pickomino_log_reader_destroy(r);
+
+    size_t games = 0;
+    r = pickomino_log_reader_create(LOG_PATH);
+    pickomino_log_event_s ev;
+    while (pickomino_log_reader_next(r, &ev)) {
+        if (ev.type == PICKOMINO_LOG_GAME_END) ++games;
+    }
+    pickomino_log_reader_destroy(r);
+
+    printf("%u games replayed\n", (unsigned)games);
+    assert(games == GAME_COUNT);
+}
+
+static void test_unfinished_game()
+{
+    pickomino_log_writer_s* log = pickomino_log_writer_create(LOG_PATH);
+    assert(log != NULL);
+    pickomino_log_game_begin(log, PLAYER_COUNT);
+    play_greedy_turn(log);
+    bool written = pickomino_log_writer_destroy(log);
+    assert(written);
+    (void)written;
+
+    pickomino_log_reader_s* r = pickomino_log_reader_create(LOG_PATH);
+    assert(r != NULL);
+    bool replayed = pickomino_log_replay(r, NULL);
+    assert(!replayed);
+    (void)replayed;
+    pickomino_log_reader_destroy(r);
+}
+
+// A single game, finished but without its GAME_END event, followed by the given bytes
+static void write_game_with_tail(const char* tail, size_t tail_len)
+{
+    pickomino_log_writer_s* log = pickomino_log_writer_create(LOG_PATH);
+    assert(log != NULL);
+
+    pickomino_game_state_s g;
+    pickomino_game_init(&g, PLAYER_COUNT);
+    pickomino_log_game_begin(log, PLAYER_COUNT);
+    while (!pickomino_game_is_done(&g)) {
+        pickomino_tile_transfer_s t = pickomino_game_process_roll(&g, play_greedy_turn(log));
+        pickomino_log_transfer(log, &t);
+        pickomino_game_next_player(&g);
+    }
+    bool written = pickomino_log_writer_destroy(log);
+    assert(written);
+    (void)written;
+
+    FILE* fp = fopen(LOG_PATH, "ab");
+    assert(fp != NULL);
+    size_t count = fwrite(tail, tail_len, 1, fp);
+    assert(count == 1);
+    (void)count;
+    fclose(fp);
+}
+
+static void test_corrupt_tail()
+{
+    static const struct {
+        const char* bytes;
+        size_t len;
+        bool decodes;           // Every event is well formed
+        bool valid;             // and the sequence follows the game
+    } tails[] = {
+        {"\x70", 1, true, true},
+        {"\x70\x00", 2, false, false},                  // Unknown event type
+        {"\x70\x2f\xff\xff", 4, false, false},          // Roll with 15 dice
+        {"\x70\x28\x01", 3, false, false},              // Roll cut off inside its outcome index
+        {"\x70\x10", 2, false, false},                  // Game with no players
+        {"\x70\x13\x28\x00\x00\x28\x00\x00\x35", 9, true, false},  // Second roll before an action
+        {"\x28\x00\x00\x70", 4, true, false},          // Roll after the last tile is gone
+    };
+
+    for (size_t idx = 0; idx < sizeof(tails) / sizeof(tails[0]); ++idx) {
+        write_game_with_tail(tails[idx].bytes, tails[idx].len);
+
+        pickomino_log_reader_s* r = pickomino_log_reader_create(LOG_PATH);
+        assert(r != NULL);
+        pickomino_log_event_s ev;
+        while (pickomino_log_reader_next(r, &ev));
+        assert(r->error == !tails[idx].decodes);
+        pickomino_log_reader_destroy(r);
+
+        r = pickomino_log_reader_create(LOG_PATH);
+        bool replayed = pickomino_log_replay(r, NULL);
+        assert(replayed == tails[idx].valid);
+        (void)replayed;
+        pickomino_log_reader_destroy(r);
+    }
+}
+
+static void test_write_error()
+{
+    // Writes to a full device fail once the buffer is flushed
+    pickomino_log_writer_s* log = pickomino_log_writer_create("/dev/full");
+    if (!log) return;
+
+    pickomino_log_game_begin(log, PLAYER_COUNT);
+    bool written = pickomino_log_writer_destroy(log);
+    assert(!written);
+    (void)written;
+}
+
+int main(int argc, char **argv)
+{
+    test_dice_index();
+    test_replay();
+    test_unfinished_game();
+    test_corrupt_tail();
+    test_write_error();
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include "solver.h"
+#include "arena.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <stdio.h>
+#include <threads.h>
+
+#define SOLVER_COUNT 4
+#define START_VALUE 21.82647470481864
+#define START_P_BUST 0.13305594701175374
+
+static void test_arena()
+{
+    arena_s* a = arena_create(1u << 20, 0);
+    assert(a != NULL);
+
+    uint8_t* p = arena_alloc(a, 100);
+    assert(((uintptr_t)p % ARENA_ALIGNMENT) == 0);
+    memset(p, 0xAB, 100);
+
+    uint8_t* q = arena_alloc(a, 1);
+    assert(q == p + 128);
+    (void)q;
+    void* too_big = arena_alloc(a, 1u << 20);
+    assert(too_big == NULL);
+    (void)too_big;
+
+    arena_reset(a);
+    uint8_t* r = arena_calloc(a, 10, 10);
+    assert(r == p);
+    for (size_t idx = 0; idx < 100; ++idx) assert(r[idx] == 0);
+    (void)r;
+
+    arena_destroy(a);
+}
+
+static int solve_worker(void* arg)
+{
+    solver_s** s = arg;
+    *s = solver_create(0);
+    assert(*s != NULL);
+    solver_solve(*s);
+    return 0;
+}
+
+static void test_parallel_solvers()
+{
+    solver_s* solvers[SOLVER_COUNT];
+    thrd_t threads[SOLVER_COUNT];
+
+    for (size_t idx = 0; idx < SOLVER_COUNT; ++idx) {
+        int rc = thrd_create(&threads[idx], solve_worker, &solvers[idx]);
+        assert(rc == thrd_success);
+        (void)rc;
+    }
+    for (size_t idx = 0; idx < SOLVER_COUNT; ++idx) {
+        thrd_join(threads[idx], NULL);
+    }
+
+    pickomino_roll_state_s start;
+    pickomino_roll_init(&start);
+    const roll_stats_s* stats = solver_find_roll_stats(solvers[0], &start);
+    printf("start: %f %f\n", stats->value, stats->p_bust);
+    assert(fabs(stats->value - START_VALUE) < 1e-9);
+    assert(fabs(stats->p_bust - START_P_BUST) < 1e-9);
+
+    size_t count = solvers[0]->total_roll_stats_count;
+    for (size_t idx = 1; idx < SOLVER_COUNT; ++idx) {
+        assert(solvers[idx]->total_roll_stats_count == count);
+        assert(memcmp(solvers[idx]->roll_stats_pool, solvers[0]->roll_stats_pool, count * sizeof(roll_stats_s)) == 0);
+    }
+    (void)count;
+
+    for (size_t idx = 0; idx < SOLVER_COUNT; ++idx) {
+        solver_destroy(solvers[idx]);
+    }
+}
+
+static void test_lazy_evaluate()
+{
+    solver_s* full = solver_create(0);
+    solver_s* lazy = solver_create(0);
+    solver_solve(full);
+
+    pickomino_roll_state_s start;
+    pickomino_roll_init(&start);
+    size_t full_touched = solver_evaluate(full, &start);
+    assert(full_touched == 0);
+    (void)full_touched;
+
+    size_t touched = solver_evaluate(lazy, &start);
+    printf("lazy: %u of %u states\n", (unsigned)touched, (unsigned)lazy->total_roll_stats_count);
+    assert(touched > 0 && touched < lazy->total_roll_stats_count);
+    size_t lazy_touched = solver_evaluate(lazy, &start);
+    assert(lazy_touched == 0);
+    (void)lazy_touched;
+
+    // Same children in the same order, so the results are bit identical
+    size_t solved = 0;
+    for (size_t idx = 0; idx < lazy->total_roll_stats_count; ++idx) {
+        if (lazy->roll_stats_solved[idx] != lazy->solved_epoch) continue;
+        ++solved;
+        assert(lazy->roll_stats_pool[idx].value == full->roll_stats_pool[idx].value);
+        assert(lazy->roll_stats_pool[idx].p_bust == full->roll_stats_pool[idx].p_bust);
+    }
+    assert(solved == touched);
+
+    // Completing the lazy solver only fills in the rest
+    solver_solve(lazy);
+    assert(memcmp(lazy->roll_stats_pool, full->roll_stats_pool, full->total_roll_stats_count * sizeof(roll_stats_s)) == 0);
+
+    // and never touches a solved state again
+    roll_stats_s* start_stats = solver_find_roll_stats(lazy, &start);
+    start_stats->value = -1;
+    solver_solve(lazy);
+    assert(start_stats->value == -1);
+
+    // A state later in the turn only builds the kernels it reaches
+    solver_s* mid = solver_create(0);
+    pickomino_roll_state_s state = {.score = 10, .dices_remaining = 5, .used_flags = 0x21, .roll_hist = {}};
+    size_t mid_touched = solver_evaluate(mid, &state);
+    assert(mid_touched > 0);
+    (void)mid_touched;
+    assert(mid->roll_kernels[0x21][5].probs != NULL);
+    assert(mid->roll_kernels[0][PICKOMINO_TOTAL_DICES].probs == NULL);
+    assert(solver_find_roll_stats(mid, &state)->value == solver_find_roll_stats(full, &state)->value);
+    solver_destroy(mid);
+
+    solver_destroy(lazy);
+    solver_destroy(full);
+}
+
+static void test_reset()
+{
+    solver_s* reference = solver_create(0);
+    solver_s* s = solver_create(0);
+    solver_solve(reference);
+
+    pickomino_roll_state_s start;
+    pickomino_roll_init(&start);
+    size_t touched = solver_evaluate(s, &start);
+
+    // Enough resets to wrap the epoch around
+    for (size_t round = 0; round < 300; ++round) {
+        solver_reset(s);
+        if (round % 100 == 0) {
+            solver_solve(s);
+            size_t resolved = solver_evaluate(s, &start);
+            assert(resolved == 0);
+            (void)resolved;
+            assert(memcmp(s->roll_stats_pool, reference->roll_stats_pool, s->total_roll_stats_count * sizeof(roll_stats_s)) == 0);
+            solver_reset(s);
+        }
+        size_t retouched = solver_evaluate(s, &start);
+        assert(retouched == touched);
+        (void)retouched;
+    }
+    (void)touched;
+
+    solver_destroy(s);
+    solver_destroy(reference);
+}
+
+// The AVX2 kernel sums the outcomes in four lanes, so it only matches the
+// scalar one up to rounding.
+static void test_kernels()
+{
+    solver_s* scalar = solver_create(SOLVER_SCALAR);
+    solver_s* dispatched = solver_create(0);
+    assert(!scalar->use_avx2);
+    printf("kernel: %s\n", dispatched->use_avx2 ? "avx2" : "scalar");
+
+    solver_solve(scalar);
+    solver_solve(dispatched);
+    for (size_t idx = 0; idx < scalar->total_roll_stats_count; ++idx) {
+        assert(fabs(dispatched->roll_stats_pool[idx].value - scalar->roll_stats_pool[idx].value) < 1e-13);
+        assert(fabs(dispatched->roll_stats_pool[idx].p_bust - scalar->roll_stats_pool[idx].p_bust) < 1e-13);
+    }
+
+    solver_destroy(dispatched);
+    solver_destroy(scalar);
+}
+
+int main(int argc, char **argv)
+{
+    test_arena();
+    test_parallel_solvers();
+    test_lazy_evaluate();
+    test_reset();
+    test_kernels();
+    return 0;
+}
@@ -0,0 +1,349 @@
+#include "pickomino_tablebase.h"
+#include "dice_combinations.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <stdio.h>
+#include <math.h>
+
+#define TABLEBASE_PATH "build/test/test_tablebase.bin"
+#define TABLEBASE_TILES 2
+#define SCORE_DIM (PICKOMINO_MAX_SCORE + 1)
+#define FLAGS_DIM (1u << TOTAL_DICE_FACES)
+#define DICE_DIM (PICKOMINO_TOTAL_DICES + 1)
+// Entries hold 12 bit probabilities; a position and its successors each round.
+#define QUANTIZATION_EPSILON 2e-3
+#define TIE_EPSILON 1e-12
+
+typedef struct
+{
+    dice_state_cache_s* dice_states[PICKOMINO_TOTAL_DICES];
+    double p_success[FLAGS_DIM][DICE_DIM][SCORE_DIM];
+    bool done[FLAGS_DIM][DICE_DIM][SCORE_DIM];
+    double mass[FLAGS_DIM][DICE_DIM][SCORE_DIM];
+    unsigned target;
+} direct_turn_s;
+
+// Chance of stopping at or above the target with a worm, when every roll takes
+// the first face with the best chance.
+static double direct_p_success(direct_turn_s* t, const pickomino_roll_state_s* r)
+{
+    if (pickomino_is_finalizeable(r) && r->score >= t->target) return 1;
+    if (r->dices_remaining == 0) return 0;
+
+    bool* done = &t->done[r->used_flags][r->dices_remaining][r->score];
+    double* p = &t->p_success[r->used_flags][r->dices_remaining][r->score];
+    if (*done) return *p;
+    *done = true;
+
+    const dice_state_cache_s* c = t->dice_states[r->dices_remaining - 1];
+    for (size_t idx = 0; idx < c->count; ++idx) {
+        unsigned available = pickomino_roll_available_actions(r, &c->states[idx]);
+        double best = -1;
+        for (unsigned action = 0; action < PICKOMINO_TOTAL_ACTIONS; ++action) {
+            if (!(available & (1u << action))) continue;
+
+            pickomino_roll_state_s next = *r;
+            pickomino_roll_action(&next, &c->states[idx], action);
+            best = fmax(best, direct_p_success(t, &next));
+        }
+        if (best > 0) *p += c->states[idx].prob * best;
+    }
+    return *p;
+}
+
+// Pushes probability mass forward through the roll states; every action adds a
+// face flag, so visiting the flags in increasing order sees all parents first.
+static void direct_turn_dist(direct_turn_s* t, unsigned target, double* dist)
+{
+    memset(t->p_success, 0, sizeof(t->p_success));
+    memset(t->done, 0, sizeof(t->done));
+    memset(t->mass, 0, sizeof(t->mass));
+    memset(dist, 0, SCORE_DIM * sizeof(double));
+    t->target = target;
+    t->mass[0][PICKOMINO_TOTAL_DICES][0] = 1;
+
+    for (unsigned flags = 0; flags < FLAGS_DIM; ++flags) {
+        for (unsigned dice = 0; dice < DICE_DIM; ++dice) {
+            for (unsigned score = 0; score < SCORE_DIM; ++score) {
+                double mass = t->mass[flags][dice][score];
+                if (mass == 0) continue;
+
+                pickomino_roll_state_s r;
+                pickomino_roll_init(&r);
+                r.used_flags = flags;
+                r.dices_remaining = dice;
+                r.score = score;
+
+                bool reached = pickomino_is_finalizeable(&r) && score >= target;
+                if (reached || dice == 0 || flags == FLAGS_DIM - 1) {
+                    dist[pickomino_roll_finalize(&r)] += mass;
+                    continue;
+                }
+
+                const dice_state_cache_s* c = t->dice_states[dice - 1];
+                for (size_t idx = 0; idx < c->count; ++idx) {
+                    const dice_state_s* d = &c->states[idx];
+                    unsigned available = pickomino_roll_available_actions(&r, d);
+                    pickomino_roll_state_s best = r;
+                    double best_p = -1;
+
+                    for (unsigned action = 0; action < PICKOMINO_TOTAL_ACTIONS; ++action) {
+                        if (!(available & (1u << action))) continue;
+
+                        pickomino_roll_state_s next = r;
+                        pickomino_roll_action(&next, d, action);
+                        double p = direct_p_success(t, &next);
+                        if (p > best_p + TIE_EPSILON) {
+                            best_p = p;
+                            best = next;
+                        }
+                    }
+
+                    if (best_p < 0) dist[PICKOMINO_ROLL_BUSTED] += mass * d->prob;
+                    else t->mass[best.used_flags][best.dices_remaining][best.score] += mass * d->prob;
+                }
+            }
+        }
+    }
+}
+
+static void test_turn_dists()
+{
+    direct_turn_s* t = calloc(1, sizeof(direct_turn_s));
+    for (size_t dice_id = 0; dice_id < PICKOMINO_TOTAL_DICES; ++dice_id) {
+        t->dice_states[dice_id] = dice_state_cache_create(dice_id + 1);
+    }
+
+    for (unsigned target = PICKOMINO_ROLL_REWARD_SCORE_BEGIN;
+         target < PICKOMINO_ROLL_REWARD_SCORE_BEGIN + PICKOMINO_ROLL_REWARD_DIM; ++target) {
+        double expected[SCORE_DIM], dist[SCORE_DIM];
+        direct_turn_dist(t, target, expected);
+        pickomino_tablebase_turn_dist(target, dist);
+
+        double total = 0, forced = 0;
+        for (unsigned score = 0; score < SCORE_DIM; ++score) {
+            assert(fabs(dist[score] - expected[score]) < 1e-12);
+            total += dist[score];
+            if (score != PICKOMINO_ROLL_BUSTED && score < target) forced += dist[score];
+        }
+        assert(fabs(total - 1) < 1e-12);
+
+        printf("target %u: bust %.4f, forced stop below target %.4f\n",
+               target, dist[PICKOMINO_ROLL_BUSTED], forced);
+    }
+
+    for (size_t dice_id = 0; dice_id < PICKOMINO_TOTAL_DICES; ++dice_id) {
+        dice_state_cache_destroy(t->dice_states[dice_id]);
+    }
+    free(t);
+}
+
+// Two player game with only the given tile left in the center.
+static void endgame_init(pickomino_game_state_s* g, unsigned tile, int diff)
+{
+    pickomino_game_init(g, 2);
+    for (size_t idx = 0; idx < PICKOMINO_ROLL_REWARD_DIM; ++idx) {
+        if (idx != tile) g->tile_states[idx] = PICKOMINO_TILE_REMOVED;
+    }
+    g->player_scores[0] = PICKOMINO_TABLEBASE_MAX_DIFF + diff;
+    g->player_scores[1] = PICKOMINO_TABLEBASE_MAX_DIFF;
+}
+
+static pickomino_tablebase_entry_s probe_entry(const pickomino_tablebase_s* tb, const pickomino_game_state_s* g)
+{
+    pickomino_tablebase_entry_s e;
+    bool found = pickomino_tablebase_probe(tb, g, &e);
+    assert(found);
+    (void)found;
+    return e;
+}
+
+static void test_values(const pickomino_tablebase_s* tb)
+{
+    for (unsigned tile = 0; tile < PICKOMINO_ROLL_REWARD_DIM; ++tile) {
+        pickomino_game_state_s g;
+        pickomino_tablebase_entry_s ahead, behind, even;
+
+        endgame_init(&g, tile, PICKOMINO_TABLEBASE_MAX_DIFF);
+        ahead = probe_entry(tb, &g);
+        endgame_init(&g, tile, -PICKOMINO_TABLEBASE_MAX_DIFF);
+        behind = probe_entry(tb, &g);
+        endgame_init(&g, tile, 0);
+        even = probe_entry(tb, &g);
+
+        printf("tile %u: %.3f %.3f %.3f, target %u\n",
+               PICKOMINO_ROLL_REWARD_SCORE_BEGIN + tile,
+               behind.win_prob, even.win_prob, ahead.win_prob, even.target_score);
+        assert(ahead.win_prob > 0.99);
+        assert(behind.win_prob < 0.01);
+        assert(behind.win_prob <= even.win_prob && even.win_prob <= ahead.win_prob);
+        // Moving first with no tiles taken yet is an advantage.
+        assert(even.win_prob > 0.5);
+        assert(even.target_score >= PICKOMINO_ROLL_REWARD_SCORE_BEGIN
+               && even.target_score < PICKOMINO_ROLL_REWARD_SCORE_BEGIN + PICKOMINO_ROLL_REWARD_DIM);
+    }
+}
+
+static double probe_win(const pickomino_tablebase_s* tb, const pickomino_game_state_s* g)
+{
+    return probe_entry(tb, g).win_prob;
+}
+
+// Win chance of playing towards target, one turn ahead of the tablebase: each
+// final score is applied by the game engine and the resulting position probed.
+// Only used with two tiles left, so a single turn never ends the game.
+static double one_turn_value(const pickomino_tablebase_s* tb, const pickomino_game_state_s* g, unsigned target)
+{
+    double dist[SCORE_DIM];
+    pickomino_tablebase_turn_dist(target, dist);
+
+    double v = 0;
+    for (unsigned score = 0; score < SCORE_DIM; ++score) {
+        if (dist[score] == 0) continue;
+
+        pickomino_game_state_s next = *g;
+        pickomino_game_process_roll(&next, score);
+        pickomino_game_next_player(&next);
+        if (pickomino_game_is_done(&next)) {
+            int diff = (int)next.player_scores[g->cur_player_id] - (int)next.player_scores[1 - g->cur_player_id];
+            v += dist[score] * (diff > 0 ? 1.0 : diff == 0 ? 0.5 : 0.0);
+        } else {
+            v += dist[score] * (1 - probe_win(tb, &next));
+        }
+    }
+    return v;
+}
+
+// Two tiles left, the opponent holding at most one tile: the stored value and
+// target must satisfy the one turn lookahead over the engine's own moves.
+static void test_two_tiles(const pickomino_tablebase_s* tb)
+{
+    const unsigned pairs[][2] = {{0, 1}, {3, 15}, {8, 9}, {12, 15}, {14, 15}};
+    const unsigned other_tops[] = {0, 5, 10, 15, PICKOMINO_ROLL_REWARD_DIM};
+    for (size_t pair = 0; pair < sizeof(pairs) / sizeof(pairs[0]); ++pair) {
+        for (size_t top = 0; top < sizeof(other_tops) / sizeof(other_tops[0]); ++top) {
+            unsigned other_top = other_tops[top];
+            if (other_top == pairs[pair][0] || other_top == pairs[pair][1]) continue;
+
+            for (int diff = -6; diff <= 6; diff += 3) {
+                pickomino_game_state_s g;
+                pickomino_game_init(&g, 2);
+                for (size_t idx = 0; idx < PICKOMINO_ROLL_REWARD_DIM; ++idx) {
+                    if (idx != pairs[pair][0] && idx != pairs[pair][1]) g.tile_states[idx] = PICKOMINO_TILE_REMOVED;
+                }
+                if (other_top < PICKOMINO_ROLL_REWARD_DIM) {
+                    g.tile_states[other_top] = PICKOMINO_TILE_OWNED;
+                    g.player_stacks[1][0] = other_top;
+                    g.player_stack_size[1] = 1;
+                }
+                g.player_scores[1] = 8 + (other_top < PICKOMINO_ROLL_REWARD_DIM ? g_pickomino_roll_rewards[other_top] : 0);
+                g.player_scores[0] = g.player_scores[1] + diff;
+
+                pickomino_tablebase_entry_s e = probe_entry(tb, &g);
+                double stored = one_turn_value(tb, &g, e.target_score);
+                assert(fabs(stored - e.win_prob) < QUANTIZATION_EPSILON);
+                (void)stored;
+
+                for (unsigned target = PICKOMINO_ROLL_REWARD_SCORE_BEGIN;
+                     target < PICKOMINO_ROLL_REWARD_SCORE_BEGIN + PICKOMINO_ROLL_REWARD_DIM; ++target) {
+                    assert(one_turn_value(tb, &g, target) < e.win_prob + QUANTIZATION_EPSILON);
+                }
+            }
+        }
+    }
+}
+
+// One tile left and the mover holding one: busting returns the mover's tile, which
+// either replaces the center tile or, being higher, joins it at the level above.
+static void test_returned_tile(const pickomino_tablebase_s* tb)
+{
+    const unsigned centers[] = {0, 7, 14};
+    const unsigned mover_tops[] = {1, 6, 15};
+    const unsigned other_tops[] = {3, 10, PICKOMINO_ROLL_REWARD_DIM};
+    for (size_t center = 0; center < sizeof(centers) / sizeof(centers[0]); ++center) {
+        for (size_t top = 0; top < sizeof(mover_tops) / sizeof(mover_tops[0]); ++top) {
+            for (size_t other = 0; other < sizeof(other_tops) / sizeof(other_tops[0]); ++other) {
+                unsigned mover_top = mover_tops[top];
+                unsigned other_top = other_tops[other];
+
+                for (int diff = -6; diff <= 6; diff += 6) {
+                    pickomino_game_state_s g;
+                    pickomino_game_init(&g, 2);
+                    for (size_t idx = 0; idx < PICKOMINO_ROLL_REWARD_DIM; ++idx) {
+                        if (idx != centers[center]) g.tile_states[idx] = PICKOMINO_TILE_REMOVED;
+                    }
+                    g.tile_states[mover_top] = PICKOMINO_TILE_OWNED;
+                    g.player_stacks[0][0] = mover_top;
+                    g.player_stack_size[0] = 1;
+                    if (other_top < PICKOMINO_ROLL_REWARD_DIM) {
+                        g.tile_states[other_top] = PICKOMINO_TILE_OWNED;
+                        g.player_stacks[1][0] = other_top;
+                        g.player_stack_size[1] = 1;
+                    }
+                    g.player_scores[1] = 8 + (other_top < PICKOMINO_ROLL_REWARD_DIM ? g_pickomino_roll_rewards[other_top] : 0);
+                    g.player_scores[0] = g.player_scores[1] + diff;
+
+                    pickomino_tablebase_entry_s e = probe_entry(tb, &g);
+                    double stored = one_turn_value(tb, &g, e.target_score);
+                    assert(fabs(stored - e.win_prob) < QUANTIZATION_EPSILON);
+                    (void)stored;
+                }
+            }
+        }
+    }
+}
+
+static void test_coverage(const pickomino_tablebase_s* tb)
+{
+    pickomino_game_state_s g;
+    pickomino_tablebase_entry_s e;
+
+    pickomino_game_init(&g, 2);
+    bool too_many_tiles = pickomino_tablebase_probe(tb, &g, &e);
+    assert(!too_many_tiles);
+
+    endgame_init(&g, 0, 0);
+    g.player_count = 3;
+    bool three_players = pickomino_tablebase_probe(tb, &g, &e);
+    assert(!three_players);
+    (void)too_many_tiles;
+    (void)three_players;
+}
+
+static void test_save_load(const pickomino_tablebase_s* tb)
+{
+    bool saved = pickomino_tablebase_save(tb, TABLEBASE_PATH);
+    assert(saved);
+    (void)saved;
+
+    pickomino_tablebase_s* loaded = pickomino_tablebase_load(TABLEBASE_PATH);
+    assert(loaded != NULL);
+    assert(loaded->max_tiles == tb->max_tiles);
+    assert(loaded->entry_count == tb->entry_count);
+    for (size_t idx = 0; idx < tb->entry_count; ++idx) {
+        assert(loaded->entries[idx] == tb->entries[idx]);
+    }
+    pickomino_tablebase_destroy(loaded);
+
+    assert(pickomino_tablebase_load("build/test/does_not_exist.bin") == NULL);
+}
+
+int main(int argc, char **argv)
+{
+    test_turn_dists();
+
+    pickomino_tablebase_s* tb = pickomino_tablebase_generate(TABLEBASE_TILES);
+    assert(tb != NULL);
+    printf("%u entries\n", (unsigned)tb->entry_count);
+
+    test_values(tb);
+    test_two_tiles(tb);
+    test_returned_tile(tb);
+    test_coverage(tb);
+    test_save_load(tb);
+
+    pickomino_tablebase_destroy(tb);
+    return 0;
+}